@@ -9,350 +9,6242 @@
 
 #include <iostream>
 #include <vector>
-#include <iomanip>
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <future>
+#include <new>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <cmath>
+#include <ctime>
+#include <thread>
+#include <type_traits>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#ifdef _WIN32
+#include <io.h>
+#define isatty _isatty
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 // Node structure definition for binary tree implementation
 struct TreeNode {
     int data_payload;           // The integer value stored in this node
+    unsigned occurrence_count;  // Insertions of this value (counting mode); fits in padding
     TreeNode* left_child_ptr;   // Pointer to the left subtree node
     TreeNode* right_child_ptr;  // Pointer to the right subtree node
     
     // Constructor initializes the node with specified data value
-    TreeNode(int value) : data_payload(value), left_child_ptr(nullptr), right_child_ptr(nullptr) {}
+    TreeNode(int value) : data_payload(value), occurrence_count(1), left_child_ptr(nullptr), right_child_ptr(nullptr) {}
+    
+    // Heap nodes are counted in the allocation ledger
+    static void* operator new(size_t byte_count);
+    static void operator delete(void* node_ptr, size_t byte_count) noexcept;
+};
+
+// Allocation accounting for tree nodes and traversal buffers (relaxed atomics: teardown may run on another thread)
+struct AllocationLedger {
+    std::atomic<uint64_t> live_nodes{0};               // Nodes currently allocated
+    std::atomic<uint64_t> node_bytes{0};               // Bytes currently held for nodes (including pool blocks)
+    std::atomic<uint64_t> peak_node_bytes{0};          // High-water mark of node_bytes for the whole run
+    std::atomic<uint64_t> phase_peak_node_bytes{0};    // High-water mark of node_bytes since begin_phase()
+    std::atomic<uint64_t> node_allocation_calls{0};    // Allocator calls made for nodes
+    std::atomic<uint64_t> node_release_calls{0};       // Deallocator calls made for nodes
+    std::atomic<uint64_t> buffer_bytes{0};             // Bytes currently held by traversal buffers
+    std::atomic<uint64_t> peak_buffer_bytes{0};        // High-water mark of buffer_bytes
+    
+    void record_node_allocation(uint64_t node_count, uint64_t byte_count, uint64_t call_count);
+    void record_node_release(uint64_t node_count, uint64_t byte_count, uint64_t call_count);
+    void record_buffer_allocation(uint64_t byte_count);
+    void record_buffer_release(uint64_t byte_count);
+    void begin_phase();
+};
+
+// Process-wide allocation ledger
+AllocationLedger allocation_ledger;
+
+// Charges a visitor traversal's explicit stack to the ledger when the walk ends; the stack only grows during a
+// walk, so its final capacity is the walk's high-water mark
+struct TraversalStackCharge {
+    const std::vector<TreeNode*>& pending_nodes;
+    explicit TraversalStackCharge(const std::vector<TreeNode*>& traversal_stack) : pending_nodes(traversal_stack) {}
+    ~TraversalStackCharge();
+};
+
+// Chunked node arena: nodes are carved from large blocks and released in bulk
+class TreeNodePool {
+public:
+    explicit TreeNodePool(size_t nodes_per_block = 65536);
+    ~TreeNodePool();
+    TreeNodePool(const TreeNodePool&) = delete;
+    TreeNodePool& operator=(const TreeNodePool&) = delete;
+    
+    TreeNode* allocate_node(int value);
+    void release_all_nodes();
+    size_t allocated_node_count() const;
+    
+private:
+    std::vector<TreeNode*> storage_blocks;  // Raw blocks of block_capacity nodes each
+    size_t block_capacity;                  // Nodes carved from each block
+    size_t current_block_used;              // Nodes used in the newest block
+    size_t live_node_count;                 // Nodes handed out since last release
+};
+
+// Index-based tree in one contiguous array: 32-bit child indices, slot 0 is the null child
+class IndexedTreePool {
+public:
+    IndexedTreePool();
+    bool insert_key(int insertion_value);
+    bool search_key(int target_value) const;   // Branchless descent
+    size_t node_count() const { return tree_nodes.size() - 1; }
+    
+private:
+    struct IndexedTreeNode {
+        int data_payload;
+        uint32_t child_index[2];   // [0] = left, [1] = right, selected by the comparison result
+    };
+    std::vector<IndexedTreeNode> tree_nodes;   // tree_nodes[0] is the null sentinel
+    uint32_t root_index = 0;
+};
+
+// Immutable node shared between tree versions; a version keeps every node reachable from its root alive
+struct PersistentTreeNode {
+    using NodeHandle = std::shared_ptr<const PersistentTreeNode>;
+    
+    int data_payload;          // The integer value stored in this node
+    NodeHandle left_child;     // Shared left subtree
+    NodeHandle right_child;    // Shared right subtree
+    
+    PersistentTreeNode(int value, NodeHandle left_subtree, NodeHandle right_subtree);
+    ~PersistentTreeNode();     // Iterative: releasing a long uniquely-owned chain must not recurse
+};
+
+// One published version of the persistent tree
+struct PersistentTreeVersion {
+    PersistentTreeNode::NodeHandle root_node;
+    size_t node_count = 0;
+    uint64_t version_number = 0;
+};
+
+// Path-copying persistent tree: one writer at a time publishes versions; readers traverse a snapshot without locks
+class PersistentTreeStore {
+public:
+    using Snapshot = std::shared_ptr<const PersistentTreeVersion>;
+    
+    PersistentTreeStore();
+    Snapshot take_snapshot() const;           // O(1); the version is reclaimed when its last snapshot drops
+    bool insert_key(int insertion_value);     // Copies only the nodes on the insertion path
+    
+private:
+    std::mutex writer_mutex;    // Serializes writers; readers never take it
+    Snapshot current_version;   // Accessed only through std::atomic_load / std::atomic_store (not lock-free)
+};
+
+// Node of a double-threaded tree: a child slot without a child holds the in-order neighbour instead
+struct ThreadedTreeNode {
+    int data_payload;                    // The integer value stored in this node
+    bool left_is_thread = true;          // Tag: left_child_ptr is a thread (nullptr at the minimum)
+    bool right_is_thread = true;         // Tag: right_child_ptr is a thread (nullptr at the maximum)
+    ThreadedTreeNode* left_child_ptr;    // Left child, or in-order predecessor when left_is_thread
+    ThreadedTreeNode* right_child_ptr;   // Right child, or in-order successor when right_is_thread
+    
+    ThreadedTreeNode(int value, ThreadedTreeNode* predecessor_ptr, ThreadedTreeNode* successor_ptr);
+    ~ThreadedTreeNode();
+};
+
+// Threaded BST: insert and erase keep the threads current, so in-order iteration needs no stack and
+// successor/predecessor are O(1) amortized (a thread hop, or one descent that a full scan pays once per edge)
+class ThreadedBinaryTree {
+public:
+    ThreadedBinaryTree() = default;
+    ~ThreadedBinaryTree();
+    ThreadedBinaryTree(const ThreadedBinaryTree&) = delete;
+    ThreadedBinaryTree& operator=(const ThreadedBinaryTree&) = delete;
+    
+    bool insert_key(int key_value);   // False for a duplicate
+    bool erase_key(int key_value);    // False when absent
+    bool contains_key(int key_value) const;
+    size_t size() const { return node_count; }
+    
+    const ThreadedTreeNode* first_node() const;
+    const ThreadedTreeNode* last_node() const;
+    const ThreadedTreeNode* lower_bound_node(int key_value) const;   // Smallest key >= key_value, or nullptr
+    static const ThreadedTreeNode* successor(const ThreadedTreeNode* node_ptr);
+    static const ThreadedTreeNode* predecessor(const ThreadedTreeNode* node_ptr);
+    template <typename KeyVisitor> bool visit_inorder(KeyVisitor&& key_visitor) const;   // Stackless
+    
+private:
+    void unlink_node(ThreadedTreeNode* parent_ptr, ThreadedTreeNode* node_ptr);   // node has at most one child
+    
+    ThreadedTreeNode* root_node = nullptr;
+    size_t node_count = 0;
+};
+
+// Finger for hinted operations: the root-to-node path of the last access with each subtree's key bounds
+struct TreeFinger {
+    struct PathEntry {
+        TreeNode* node_ptr;        // Node on the access path
+        long long lower_bound;     // Every key in node_ptr's subtree is > lower_bound
+        long long upper_bound;     // Every key in node_ptr's subtree is < upper_bound
+    };
+    std::vector<PathEntry> access_path;   // access_path[0] is the root
+    
+    // Forget the path (required after any restructuring not done through the finger)
+    void reset() { access_path.clear(); }
+};
+
+// Two-way set-associative cache of recent search results (present and absent) in front of the tree
+class HotKeyLookupCache {
+public:
+    void configure(size_t requested_sets);   // Rounded up to a power of two; 0 disables the cache
+    bool is_enabled() const { return cache_lines != nullptr; }
+    template <typename TreeLookup> bool lookup(int target_value, TreeLookup&& tree_lookup);
+    void invalidate_key(int key_value);      // Required after every insert or delete of key_value
+    void clear();
+    
+    size_t set_count() const { return is_enabled() ? set_mask + 1 : 0; }
+    uint64_t hit_count() const { return cache_hits; }
+    uint64_t miss_count() const { return cache_misses; }
+    double mean_hit_nanoseconds() const;      // From every 64th lookup
+    double mean_miss_nanoseconds() const;
+    
+private:
+    // One set holds both ways in 16 bytes; four sets share a 64-byte line so a probe touches one line
+    struct CacheSet {
+        int32_t cached_keys[2];
+        uint8_t way_state[2];       // 0 = empty, 1 = cached absent, 2 = cached present
+        uint8_t replacement_way;    // Least recently used way
+        uint8_t padding_bytes[5];
+    };
+    struct alignas(64) CacheLine {
+        CacheSet cache_sets[4];
+    };
+    CacheSet& locate_set(int key_value);
+    
+    std::unique_ptr<CacheLine[]> cache_lines;   // Null while the cache is disabled
+    size_t set_mask = 0;
+    uint64_t lookup_counter = 0;
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t sampled_hits = 0;
+    uint64_t sampled_misses = 0;
+    double sampled_hit_nanoseconds = 0.0;
+    double sampled_miss_nanoseconds = 0.0;
+};
+
+// Fixed-point formatting request for FormattedOutputBuffer (replaces std::fixed/std::setprecision)
+struct FixedPrecision {
+    double value;
+    int precision;
+    FixedPrecision(double number, int digits) : value(number), precision(digits) {}
+};
+
+// Right-aligned integer formatting request for FormattedOutputBuffer (replaces std::setw)
+struct PaddedInteger {
+    long long value;
+    int width;
+    PaddedInteger(long long number, int field_width) : value(number), width(field_width) {}
+};
+
+// Output subsystem: renders into a reusable buffer with std::to_chars and emits one write() per chunk
+// (file descriptor -1 captures in memory until drain_into() hands the text to another buffer)
+class FormattedOutputBuffer {
+public:
+    explicit FormattedOutputBuffer(int file_descriptor = 1, size_t buffer_capacity = 1 << 16);
+    ~FormattedOutputBuffer();
+    FormattedOutputBuffer(const FormattedOutputBuffer&) = delete;
+    FormattedOutputBuffer& operator=(const FormattedOutputBuffer&) = delete;
+    
+    FormattedOutputBuffer& append_text(const char* text, size_t length);
+    FormattedOutputBuffer& operator<<(const char* text);
+    FormattedOutputBuffer& operator<<(const std::string& text);
+    FormattedOutputBuffer& operator<<(char character);
+    FormattedOutputBuffer& operator<<(double value);
+    FormattedOutputBuffer& operator<<(const FixedPrecision& request);
+    FormattedOutputBuffer& operator<<(const PaddedInteger& request);
+    
+    // Integers of any width are formatted through std::to_chars
+    template <typename IntegerType, typename std::enable_if<std::is_integral<IntegerType>::value &&
+                                                            !std::is_same<IntegerType, char>::value &&
+                                                            !std::is_same<IntegerType, bool>::value, int>::type = 0>
+    FormattedOutputBuffer& operator<<(IntegerType value) {
+        reserve_space(24);
+        char* format_end = std::to_chars(buffer_storage.data() + used_bytes,
+                                         buffer_storage.data() + buffer_storage.size(), value).ptr;
+        used_bytes = format_end - buffer_storage.data();
+        return *this;
+    }
+    
+    void flush();
+    void drain_into(FormattedOutputBuffer& destination_output);
+    bool has_write_error() const { return write_failed; }   // A flush hit an error other than EINTR
+    
+private:
+    void reserve_space(size_t byte_count);
+    
+    std::vector<char> buffer_storage;  // Reusable render buffer
+    size_t used_bytes;                 // Bytes rendered but not yet written
+    int output_descriptor;             // Destination file descriptor
+    bool write_failed = false;         // Set once a write fails; the unwritten text is dropped
+};
+
+// Process-wide buffered standard output; flushed at phase boundaries and at exit
+FormattedOutputBuffer console_output(1);
+
+// Progress output style: redrawn bar on a terminal, periodic key=value lines, or nothing
+enum class ProgressOutputMode {
+    automatic,      // Terminal bar when stderr is a TTY, otherwise silent
+    terminal,       // Carriage-return redraw of a single status line
+    machine_lines,  // One "progress phase=... done=..." line per report
+    silent          // No progress output
+};
+
+// Throttled progress reporter: hot loops bump a relaxed counter, a background thread redraws on an interval
+class ProgressReporter {
+public:
+    ProgressReporter(const std::string& phase_label, uint64_t total_operations,
+                     ProgressOutputMode output_mode = ProgressOutputMode::automatic,
+                     std::chrono::milliseconds report_interval = std::chrono::milliseconds(100));
+    ~ProgressReporter();
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+    
+    // Hot-path cost: one relaxed atomic increment
+    void record_operation() {
+        completed_operations.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Batched paths report a whole chunk at once
+    void record_operations(uint64_t operation_count) {
+        completed_operations.fetch_add(operation_count, std::memory_order_relaxed);
+    }
+    
+    void finish();
+    
+private:
+    void reporter_loop();
+    void render_report(bool final_report);
+    
+    std::string phase_name;                             // Label shown in every report
+    uint64_t operation_total;                           // Expected number of operations
+    ProgressOutputMode resolved_mode;                   // Mode after TTY detection
+    std::chrono::milliseconds interval_duration;        // Time between reports
+    std::chrono::steady_clock::time_point start_time;   // Phase start for rate and ETA
+    std::atomic<uint64_t> completed_operations;         // Counter bumped by the hot loop
+    FormattedOutputBuffer report_output;                // Buffered stderr writer
+    std::mutex state_mutex;                             // Guards stop_requested
+    std::condition_variable stop_signal;                // Wakes the reporter early on finish()
+    bool stop_requested;                                // Set once finish() has been called
+    std::thread reporter_thread;                        // Background redraw thread
+};
+
+// Key distribution used to generate the workload
+enum class KeyDistribution {
+    demo,       // Fixed 15-key demonstration dataset
+    sorted,     // Ascending keys (degenerate right spine for a plain BST)
+    reverse,    // Descending keys (degenerate left spine for a plain BST)
+    uniform,    // Uniformly random keys over the full int range
+    zipfian,    // Skewed repeats of popular keys (YCSB-style generator)
+    clustered   // Random keys concentrated around random cluster centres
+};
+
+// Tree construction strategy used in Phase 1
+enum class TreeVariant {
+    plain,      // insert_node_iterative() per key
+    balanced,   // insert_node_iterative() then in-place DSW rebalance
+    batch,      // insert_batch() in 64k-key batches
+    counting,   // insert_node_counting() multiset mode
+    pooled,     // insert_node_pooled() with bulk release at teardown
+    finger,     // finger_insert()/finger_search() starting from the last accessed node
+    splay       // splay_insert()/splay_search() moving accessed keys to the root
+};
+
+// Structured metrics output format
+enum class MetricsFormat {
+    disabled,    // No metrics are collected
+    json_lines,  // One JSON object per phase
+    csv          // One "phase,metric,value" row per metric
+};
+
+// Depth-first visiting orders
+enum class TraversalOrder {
+    inorder,     // Left-Root-Right (sorted keys)
+    preorder,    // Root-Left-Right
+    postorder    // Left-Right-Root
+};
+
+// How Phase 5 obtains its statistics
+enum class StatisticsMode {
+    exact,         // Scan the tree in order
+    incremental,   // Read the accumulator maintained by every insert and delete
+    sketch         // Summarize the raw key stream with exact moments and a KLL quantile sketch
+};
+
+// How Phases 2, 3 and 5 read the tree
+enum class AnalysisMode {
+    separate,   // Each phase walks the tree itself
+    fused       // One walk fills height, count, all three orders and the statistics
+};
+
+// How Phases 2-5 are executed
+enum class PhaseSchedule {
+    serial,       // In phase order on the main thread, output streamed
+    concurrent    // Task graph on a thread pool, output committed in phase order
+};
+
+// Command-line configuration for the demo / load generator
+struct DriverOptions {
+    size_t key_count = 15;                                          // Keys to generate
+    KeyDistribution key_distribution = KeyDistribution::demo;       // Key generator
+    uint64_t random_seed = 42;                                      // Seed for reproducible workloads
+    unsigned enabled_phase_mask = 0x7E;                             // Bit N set when phase N runs
+    TreeVariant tree_variant = TreeVariant::plain;                  // Construction strategy
+    unsigned thread_count = 0;                                      // Worker threads (0 = hardware)
+    size_t search_count = 1000;                                     // Phase 4 lookups for generated workloads
+    size_t display_limit = 64;                                      // Traversal elements printed per line
+    ProgressOutputMode progress_mode = ProgressOutputMode::automatic;
+    MetricsFormat metrics_format = MetricsFormat::disabled;        // Structured metrics output
+    std::string metrics_path = "-";                                 // Metrics destination ("-" = stdout)
+    size_t lookup_cache_sets = 0;                                   // Search-result cache sets (0 = off)
+    unsigned bloom_bits_per_key = 0;                                // Negative-lookup filter size (0 = off)
+    StatisticsMode statistics_mode = StatisticsMode::exact;         // Phase 5 strategy
+    std::vector<double> reported_percentiles;                       // Phase 5 percentiles, e.g. 50, 99.9 (empty = none)
+    double sketch_rank_error = 0.01;                                // Quantile sketch rank error bound
+    AnalysisMode analysis_mode = AnalysisMode::separate;            // Per-phase walks or one fused walk
+    PhaseSchedule phase_schedule = PhaseSchedule::serial;           // Phase 2-5 execution strategy
+    bool show_help = false;
+};
+
+// YCSB-style Zipfian rank generator (Gray et al.), O(1) per sample after O(n) set-up
+class ZipfianKeyGenerator {
+public:
+    ZipfianKeyGenerator(uint64_t item_count, double skew_exponent = 0.99);
+    uint64_t next_rank(std::mt19937_64& random_engine);
+    
+private:
+    uint64_t item_total;     // Number of distinct ranks
+    double theta_exponent;   // Skew; 0.99 matches YCSB
+    double zeta_total;       // Generalized harmonic number for item_total
+    double alpha_factor;     // 1 / (1 - theta)
+    double eta_factor;       // Correction term for ranks >= 2
+};
+
+// Phase 1 keys produced one at a time (same sequence as generate_workload_keys()), so a run that only sketches
+// them never holds the workload in memory
+class WorkloadKeyStream {
+public:
+    explicit WorkloadKeyStream(const DriverOptions& driver_options);
+    size_t size() const { return key_total; }
+    bool next_key(int& key_value);   // False once every key has been produced
+    
+private:
+    KeyDistribution key_distribution;
+    size_t key_total;
+    size_t next_index = 0;
+    std::mt19937_64 random_engine;
+    std::uniform_int_distribution<int> uniform_distribution{INT_MIN, INT_MAX};
+    std::unique_ptr<ZipfianKeyGenerator> rank_generator;     // Zipfian workloads only
+    std::vector<int> cluster_centres;                        // Clustered workloads only (one per ~1024 keys)
+    std::uniform_int_distribution<size_t> cluster_choice;
+    std::normal_distribution<double> offset_distribution{0.0, 4096.0};
+};
+
+// What a phase timer may attribute to its phase
+enum class PhaseTimerScope {
+    process,   // The phase runs alone: process CPU time and ledger deltas are its own
+    task       // The phase shares the process with concurrent phases: only wall time is its own
+};
+
+// Wall-clock and CPU time for one phase
+struct PhaseTimer {
+    std::chrono::steady_clock::time_point wall_start;
+    std::clock_t cpu_start;
+    uint64_t node_allocation_calls_start;   // Ledger counters at phase start
+    uint64_t node_release_calls_start;
+    PhaseTimerScope timer_scope;
+    
+    explicit PhaseTimer(PhaseTimerScope scope = PhaseTimerScope::process)
+        : wall_start(std::chrono::steady_clock::now()), cpu_start(std::clock()),
+          node_allocation_calls_start(allocation_ledger.node_allocation_calls.load(std::memory_order_relaxed)),
+          node_release_calls_start(allocation_ledger.node_release_calls.load(std::memory_order_relaxed)), timer_scope(scope) {
+        // Task timers leave the shared phase peak alone; other phases may be measuring it
+        if (timer_scope == PhaseTimerScope::process) {
+            allocation_ledger.begin_phase();
+        }
+    }
+    bool owns_process_resources() const { return timer_scope == PhaseTimerScope::process; }
+    double wall_milliseconds() const;
+    double cpu_milliseconds() const;
+};
+
+// Summary statistics reported by Phase 5
+struct DatasetStatistics {
+    size_t element_count = 0;    // Number of values analysed
+    long long sum_total = 0;     // 64-bit sum of all values
+    double mean_value = 0.0;     // Arithmetic mean
+    double median_value = 0.0;   // Middle value (mean of the two middle values for even counts)
+    bool median_is_estimate = false;   // Median read from a quantile sketch rather than an exact rank
+    int minimum_value = 0;       // Smallest value
+    int maximum_value = 0;       // Largest value
+    long long value_range = 0;   // maximum_value - minimum_value
+};
+
+// Everything Phases 2, 3 and 5 need from the tree, gathered in one walk
+struct TreeAnalysis {
+    int tree_height = 0;                  // Same as calculate_tree_height()
+    size_t node_count = 0;                // Same as count_total_nodes()
+    std::vector<int> inorder_keys;        // Same as perform_inorder_traversal()
+    std::vector<int> preorder_keys;       // Same as perform_preorder_traversal()
+    std::vector<int> postorder_keys;      // Same as perform_postorder_traversal()
+    DatasetStatistics statistics;         // Same as compute_dataset_statistics(inorder_keys)
+};
+
+// Per-phase metrics emitter for dashboards; every call is a single branch when disabled
+class MetricsRecorder {
+public:
+    ~MetricsRecorder();
+    bool configure(MetricsFormat output_format, const std::string& output_path);
+    void configure_capture(MetricsFormat output_format);           // Hold records in memory (no CSV header)
+    void commit_captured_records(MetricsRecorder& destination_recorder);
+    bool is_enabled() const { return metrics_format != MetricsFormat::disabled; }
+    
+    void begin_phase(const char* phase_name);
+    void record_integer(const char* metric_name, long long metric_value);
+    void record_decimal(const char* metric_name, double metric_value);
+    void record_text(const char* metric_name, const std::string& metric_value);
+    void end_phase(const PhaseTimer& phase_timer);
+    
+private:
+    void append_field(const char* metric_name, const std::string& rendered_value, bool quoted);
+    void flush_records();
+    
+    MetricsFormat metrics_format = MetricsFormat::disabled;   // Selected output format
+    std::unique_ptr<FormattedOutputBuffer> metrics_output;    // Destination writer
+    int metrics_descriptor = -1;                              // File descriptor owned when writing to a file
+    bool shares_console_output = false;                       // Records go to stdout between console text
+    std::string current_phase;                                // Phase currently being recorded
+    std::string pending_record;                               // Rendered fields for the current phase
+};
+
+// Process-wide metrics emitter configured from the command line
+MetricsRecorder metrics_recorder;
+
+// How a phase touches the shared tree; exclusive phases (splaying, Morris threading) restructure it
+enum class TreeAccess {
+    none,
+    shared,
+    exclusive
+};
+
+// Dependency graph of driver phases. Edges come from declared tree access (a shared task follows the last
+// exclusive one; an exclusive task follows everything before it that touches the tree) plus explicit
+// dependencies, always on earlier tasks, so declaration order is a valid serial schedule
+class PhaseTaskGraph {
+public:
+    size_t add_task(const char* task_name, TreeAccess tree_access, std::function<void()> task_body,
+                    const std::vector<size_t>& extra_dependencies = {});
+    void run_serial();
+    void run_concurrent(unsigned thread_count);
+    size_t task_count() const { return phase_tasks.size(); }
+    const char* task_name(size_t task_index) const { return phase_tasks[task_index].task_name; }
+    double task_wall_milliseconds(size_t task_index) const { return phase_tasks[task_index].wall_milliseconds; }
+    
+private:
+    struct PhaseTask {
+        const char* task_name;
+        std::function<void()> task_body;
+        std::vector<size_t> dependent_tasks;   // Tasks waiting on this one
+        size_t dependency_count = 0;           // Distinct tasks this one waits on
+        double wall_milliseconds = 0.0;
+    };
+    void add_dependency(size_t prerequisite_index, size_t dependent_index);
+    void run_task(size_t task_index);
+    
+    std::vector<PhaseTask> phase_tasks;
+    std::vector<size_t> shared_since_exclusive;   // Tree readers since the last exclusive task
+    size_t last_exclusive_task = SIZE_MAX;
+};
+
+// Split-block Bloom filter: one 512-bit block per key, one bit in each of its eight 64-bit words
+class BlockedBloomFilter {
+public:
+    void configure(size_t expected_keys, unsigned bits_per_key);   // bits_per_key == 0 disables the filter
+    bool is_enabled() const { return !filter_blocks.empty(); }
+    void insert_key(int key_value);
+    bool may_contain(int key_value) const;   // False means the key is definitely absent
+    size_t block_count() const { return filter_blocks.size(); }
+    size_t memory_bytes() const { return filter_blocks.size() * sizeof(FilterBlock); }
+    
+private:
+    struct alignas(64) FilterBlock {
+        uint64_t filter_words[8];
+    };
+    static void compute_block_mask(uint32_t key_hash, uint64_t (&block_mask)[8]);
+    size_t locate_block(uint64_t key_hash) const;
+    
+    std::vector<FilterBlock> filter_blocks;   // Empty while the filter is disabled
+};
+
+// Size-augmented treap (hash-derived priorities) answering rank and select queries in O(log n)
+class OrderStatisticTree {
+public:
+    OrderStatisticTree() = default;
+    ~OrderStatisticTree();
+    OrderStatisticTree(const OrderStatisticTree&) = delete;
+    OrderStatisticTree& operator=(const OrderStatisticTree&) = delete;
+    
+    bool insert_key(int insertion_value);          // False for duplicates
+    bool erase_key(int target_value);              // False when absent
+    size_t size() const;
+    int select_key(size_t key_rank) const;         // key_rank-th smallest key (0-based); requires key_rank < size()
+    size_t count_keys_below(int key_value) const;  // Number of keys < key_value
+    
+private:
+    struct RankedTreeNode {
+        int data_payload;
+        uint32_t subtree_size;             // Nodes in this subtree, including itself
+        RankedTreeNode* left_child_ptr;
+        RankedTreeNode* right_child_ptr;
+    };
+    static uint32_t subtree_size(const RankedTreeNode* node_ptr) { return node_ptr != nullptr ? node_ptr->subtree_size : 0; }
+    static void split_ranked(RankedTreeNode* node_ptr, int split_key, RankedTreeNode*& less_root_ptr,
+                             RankedTreeNode*& greater_root_ptr);
+    static RankedTreeNode* join_ranked(RankedTreeNode* left_root_ptr, RankedTreeNode* right_root_ptr);
+    
+    RankedTreeNode* root_ptr = nullptr;
+};
+
+// Phase 5 statistics kept current on every insert and delete instead of rescanning the tree. Ranks come from a
+// separate size-augmented treap rather than sizes on TreeNode: DSW rebalancing, splaying, batch builds and the
+// set operations restructure the driver tree without maintaining subtree sizes, and a size field would grow every
+// node from 24 to 32 bytes whether or not statistics are tracked. The price, paid only with --statistics incremental,
+// is a second 24-byte node and O(log n) insert per distinct key.
+class IncrementalStatistics {
+public:
+    void enable() { tracking_enabled = true; }
+    bool is_enabled() const { return tracking_enabled; }
+    void record_insert(int key_value);   // Duplicates are ignored, matching the tree
+    void record_delete(int key_value);
+    DatasetStatistics current_statistics(TreeNode* root_ptr) const;   // O(log n): min/max from the tree's edges
+    double standard_deviation() const;                                  // Population standard deviation
+    const OrderStatisticTree& order_statistics() const { return ranked_keys; }
+    
+private:
+    bool tracking_enabled = false;
+    long long sum_total = 0;              // 64-bit sum of the distinct keys
+    long double sum_of_squares = 0.0L;    // Sum of squared keys (exceeds 64-bit integers)
+    OrderStatisticTree ranked_keys;       // Key ranks for the median
+};
+
+// KLL quantile sketch (Karnin-Lang-Liberty): bounded memory, mergeable, rank error about epsilon
+class KllQuantileSketch {
+public:
+    explicit KllQuantileSketch(double rank_error = 0.01);
+    void insert_value(int value);
+    void merge_from(const KllQuantileSketch& other_sketch);
+    int quantile_value(double quantile) const;   // Nearest-rank estimate; requires value_count() > 0
+    uint64_t value_count() const { return total_count; }
+    size_t retained_item_count() const { return retained_items; }
+    double rank_error_bound() const { return target_rank_error; }
+    
+private:
+    size_t level_capacity(size_t level_index) const;
+    void refresh_capacity();
+    void compact_level(size_t level_index);
+    void compress_levels();
+    
+    double target_rank_error;                          // Requested normalized rank error
+    size_t sketch_k;                                   // Capacity of the top compactor
+    uint64_t total_count = 0;                          // Values summarized
+    size_t retained_items = 0;                         // Items across all levels
+    size_t capacity_budget = 0;                        // Sum of level capacities; changes only with the level count
+    uint64_t coin_state = 0x9E3779B97F4A7C15ULL;       // Compaction offsets (deterministic per sketch)
+    std::vector<std::vector<int>> compactor_levels;    // Items at level h carry weight 2^h
+};
+
+// Exact count/sum/min/max plus sketched quantiles over an unbounded stream; one per thread, then merged
+class StreamingStatistics {
+public:
+    explicit StreamingStatistics(double rank_error = 0.01) : quantile_sketch(rank_error) {}
+    void record_value(int value);
+    void merge_from(const StreamingStatistics& other_statistics);
+    DatasetStatistics summary() const;   // Phase 5 fields; the median is the sketch's estimate
+    const KllQuantileSketch& sketch() const { return quantile_sketch; }
+    
+private:
+    long long sum_total = 0;
+    int minimum_value = INT_MAX;
+    int maximum_value = INT_MIN;
+    KllQuantileSketch quantile_sketch;
+};
+
+// Tree and per-variant state shared by the driver phases
+struct DriverTreeState {
+    TreeNode* root_ptr = nullptr;                    // Root of the tree being analysed
+    size_t node_count = 0;                           // Distinct keys inserted so far
+    TreeVariant tree_variant = TreeVariant::plain;   // Construction / lookup strategy
+    TreeNodePool node_pool;                          // Node storage for the pooled variant
+    TreeFinger access_finger;                        // Last-access path for the finger variant
+    HotKeyLookupCache lookup_cache;                  // Optional search-result cache (--lookup-cache)
+    BlockedBloomFilter key_filter;                   // Optional negative-lookup filter (--bloom-filter)
+    uint64_t filter_rejections = 0;                  // Searches answered by the filter alone
+    uint64_t filter_false_positives = 0;             // Searches the filter passed that the tree then missed
+    IncrementalStatistics running_statistics;        // Phase 5 accumulator (--statistics incremental)
 };
 
+// Worker thread count selected on the command line (0 = hardware concurrency)
+unsigned configured_worker_threads = 0;
+
 // Function declarations for binary tree operations
 TreeNode* insert_node_iterative(TreeNode* root_ptr, int insertion_value);
+bool insert_node_unique(TreeNode*& root_ptr, int insertion_value);
+bool insert_node_counting(TreeNode*& root_ptr, int insertion_value);
+unsigned count_key_occurrences(TreeNode* root_ptr, int target_value);
 void perform_inorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results);
 void perform_preorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results);
 void perform_postorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results);
+// Visitor traversals: the callable is inlined per call site and returns false to stop early (the walk then returns false)
+template <typename KeyVisitor> bool visit_inorder(TreeNode* current_node, KeyVisitor&& key_visitor);
+template <typename KeyVisitor> bool visit_preorder(TreeNode* current_node, KeyVisitor&& key_visitor);
+template <typename KeyVisitor> bool visit_postorder(TreeNode* current_node, KeyVisitor&& key_visitor);
+template <typename KeyVisitor> bool visit_tree(TreeNode* root_ptr, TraversalOrder traversal_order, KeyVisitor&& key_visitor);
 int calculate_tree_height(TreeNode* current_node);
 int count_total_nodes(TreeNode* current_node);
 bool search_node_value(TreeNode* current_node, int target_value);
-void display_progress_indicator(int current_step, int total_steps);
-void display_traversal_results(const std::vector<int>& results, const std::string& traversal_type);
-void perform_statistical_analysis(const std::vector<int>& dataset);
+bool search_node_value_branchless(TreeNode* current_node, int target_value);
+TreeNode* unlink_node_value(TreeNode*& root_ptr, int target_value);
+bool delete_node_value(TreeNode*& root_ptr, int target_value);
+void display_progress_indicator(FormattedOutputBuffer& output, uint64_t current_step, uint64_t total_steps);
+void display_traversal_results(TreeNode* root_ptr, TraversalOrder traversal_order, size_t element_count,
+                               const std::string& traversal_type, size_t display_limit = SIZE_MAX,
+                               FormattedOutputBuffer& output = console_output);
+DatasetStatistics perform_statistical_analysis(TreeNode* root_ptr, size_t node_count, FormattedOutputBuffer& output = console_output);
+DatasetStatistics compute_dataset_statistics(const std::vector<int>& dataset);
+DatasetStatistics compute_tree_statistics(TreeNode* root_ptr, size_t node_count);
+void display_traversal_results(const std::vector<int>& results, const std::string& traversal_type,
+                               size_t display_limit = SIZE_MAX, FormattedOutputBuffer& output = console_output);
+TreeAnalysis analyze_tree_single_pass(TreeNode* root_ptr, size_t expected_node_count = 0);
+bool tree_analysis_matches(TreeNode* root_ptr, const TreeAnalysis& tree_analysis);
+void display_dataset_statistics(const DatasetStatistics& statistics, FormattedOutputBuffer& output = console_output);
+void record_dataset_statistics(const DatasetStatistics& statistics, MetricsRecorder& recorder = metrics_recorder);
 void deallocate_tree_memory(TreeNode* current_node);
+std::future<void> deallocate_tree_memory_async(TreeNode* root_ptr);
+TreeNode* insert_node_pooled(TreeNode* root_ptr, int insertion_value, TreeNodePool& node_pool);
+TreeNode* rebalance_tree_in_place(TreeNode* root_ptr);
+TreeNode* build_balanced_tree(const std::vector<int>& sorted_values, size_t range_begin, size_t range_end);
+size_t insert_batch(TreeNode*& root_ptr, std::vector<int>& batch_values, size_t tree_node_count);
+bool treap_insert(TreeNode*& root_ptr, int insertion_value);
+TreeNode* convert_to_treap(TreeNode* root_ptr);
+void split_treap(TreeNode* root_ptr, int split_key, TreeNode*& less_root_ptr, TreeNode*& equal_node_ptr,
+                 TreeNode*& greater_root_ptr);
+TreeNode* join_treaps(TreeNode* left_root_ptr, TreeNode* right_root_ptr);
+TreeNode* tree_union(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count = 0);
+TreeNode* tree_intersection(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count = 0);
+TreeNode* tree_difference(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count = 0);
+// Split/join/move keep O(log n) depth only on treaps (treap_insert() or convert_to_treap() first); other trees
+// come back as valid but possibly degenerate BSTs
+void split_tree_by_key(TreeNode* root_ptr, int split_key, TreeNode*& left_root_ptr, TreeNode*& right_root_ptr);
+TreeNode* join_trees(TreeNode* left_root_ptr, TreeNode* right_root_ptr);
+void move_key_range(TreeNode*& source_root_ptr, TreeNode*& destination_root_ptr, int range_low, int range_high);
+template <typename KeyType> void radix_sort_keys(std::vector<KeyType>& keys, unsigned thread_count = 0);
+long read_process_memory_kib(const std::string& status_field);
+long read_resident_memory_kib();
+void reset_peak_memory_watermark();
+int run_benchmark_command(int argc, char* argv[]);
+void run_rebalance_benchmark(size_t node_count);
+void run_teardown_benchmark(size_t node_count);
+void run_batch_insert_benchmark(size_t node_count);
+void run_radix_sort_benchmark(size_t key_count);
+void run_output_benchmark(size_t element_count);
+void run_finger_benchmark(size_t key_count);
+void run_splay_benchmark(size_t key_count);
+void run_lookup_cache_benchmark(size_t key_count);
+void run_bloom_filter_benchmark(size_t key_count);
+void run_branchless_search_benchmark(size_t key_count);
+void run_snapshot_benchmark(size_t key_count);
+void run_set_operation_benchmark(size_t key_count);
+void run_reshard_benchmark(size_t key_count);
+void run_incremental_statistics_benchmark(size_t key_count);
+void run_quantile_benchmark(size_t key_count);
+void run_sketch_benchmark(size_t value_count);
+void run_visitor_benchmark(size_t key_count);
+void run_fused_analysis_benchmark(size_t key_count);
+void run_threaded_tree_benchmark(size_t key_count);
+StreamingStatistics summarize_key_stream(const std::vector<int>& key_stream, double rank_error, unsigned thread_count = 0);
+size_t quantile_rank(double quantile, size_t element_count);
+int select_quantile(const OrderStatisticTree& ranked_keys, double quantile);
+std::vector<int> tree_quantiles(TreeNode* root_ptr, size_t node_count, const std::vector<double>& quantiles);
+bool persistent_search(const PersistentTreeNode* current_node, int target_value);
+void collect_persistent_inorder(const PersistentTreeNode* root_node, std::vector<int>& traversal_results);
+bool parse_driver_options(int argc, char* argv[], DriverOptions& driver_options);
+void display_usage(const char* program_name);
+std::vector<int> generate_workload_keys(const DriverOptions& driver_options);
+std::vector<int> generate_search_targets(const DriverOptions& driver_options, const std::vector<int>& input_dataset);
+bool phase_is_enabled(const DriverOptions& driver_options, int phase_number);
+size_t insert_workload_key(DriverTreeState& tree_state, int insertion_value);
+size_t delete_workload_key(DriverTreeState& tree_state, int target_value);
+bool search_workload_key(DriverTreeState& tree_state, int target_value);
+bool finger_search(TreeNode* root_ptr, TreeFinger& access_finger, int target_value);
+bool finger_insert(TreeNode*& root_ptr, TreeFinger& access_finger, int insertion_value);
+TreeNode* splay_tree_access(TreeNode* root_ptr, int target_value);
+bool splay_search(TreeNode*& root_ptr, int target_value);
+bool splay_insert(TreeNode*& root_ptr, int insertion_value);
+void display_phase_timing(const PhaseTimer& phase_timer, FormattedOutputBuffer& output = console_output);
+const char* key_distribution_name(KeyDistribution key_distribution);
+const char* tree_variant_name(TreeVariant tree_variant);
+uint64_t scramble_key_bits(uint64_t key_bits);
+unsigned resolve_worker_thread_count(unsigned requested_threads);
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Optional benchmark mode: --benchmark <name> [node_count ...]
+    if (argc >= 2 && std::string(argv[1]) == "--benchmark") {
+        return run_benchmark_command(argc, argv);
+    }
+    
+    // Parse workload, phase and variant selection from the command line
+    DriverOptions driver_options;
+    if (!parse_driver_options(argc, argv, driver_options)) {
+        std::cerr << "Run '" << argv[0] << " --help' for usage.\n";
+        return 1;
+    }
+    if (driver_options.show_help) {
+        display_usage(argv[0]);
+        return 0;
+    }
+    configured_worker_threads = driver_options.thread_count;
+    if (!metrics_recorder.configure(driver_options.metrics_format, driver_options.metrics_path)) {
+        std::cerr << "Cannot open metrics output: " << driver_options.metrics_path << "\n";
+        return 1;
+    }
+    
     // Program initialization and header display
-    std::cout << "========================================\n";
-    std::cout << "   Binary Tree Professional Demo\n";
-    std::cout << "   Advanced Data Structure Analysis\n";
-    std::cout << "========================================\n\n";
+    console_output << "========================================\n";
+    console_output << "   Binary Tree Professional Demo\n";
+    console_output << "   Advanced Data Structure Analysis\n";
+    console_output << "========================================\n\n";
     
     // Initialize root pointer for binary search tree
-    TreeNode* tree_root_ptr = nullptr;
+    DriverTreeState tree_state;
+    tree_state.tree_variant = driver_options.tree_variant;
+    tree_state.lookup_cache.configure(driver_options.lookup_cache_sets);
+    tree_state.key_filter.configure(driver_options.key_count, driver_options.bloom_bits_per_key);
+    if (driver_options.statistics_mode == StatisticsMode::incremental) {
+        tree_state.running_statistics.enable();
+    }
+    
+    // Sketch-only runs (no phase reads the tree) stream the workload straight into the Phase 5 sketch, so
+    // neither the keys nor a tree are ever held in memory
+    bool sketch_only = driver_options.statistics_mode == StatisticsMode::sketch && !phase_is_enabled(driver_options, 2) &&
+                       !phase_is_enabled(driver_options, 3) && !phase_is_enabled(driver_options, 4);
+    
+    // Deterministic dataset: fixed demo keys or a seeded generated workload
+    std::vector<int> input_dataset;
+    if (!sketch_only) {
+        input_dataset = generate_workload_keys(driver_options);
+    }
+    size_t total_operations = input_dataset.size();
+    
+    console_output << "Phase 1: Tree Construction and Node Insertion\n";
+    console_output << "---------------------------------------------\n";
+    console_output.flush();
+    PhaseTimer construction_timer;
+    metrics_recorder.begin_phase("construction");
+    if (metrics_recorder.is_enabled()) {
+        metrics_recorder.record_text("distribution", key_distribution_name(driver_options.key_distribution));
+        metrics_recorder.record_text("variant", tree_variant_name(driver_options.tree_variant));
+        metrics_recorder.record_integer("seed", static_cast<long long>(driver_options.random_seed));
+        metrics_recorder.record_integer("threads", resolve_worker_thread_count(driver_options.thread_count));
+    }
+    
+    // Small datasets log every insertion; larger ones report throttled progress on stderr
+    const size_t detailed_insert_log_limit = 32;
+    
+    if (sketch_only) {
+        console_output << "Tree construction skipped: Phase 5 streams the workload into its quantile sketch\n";
+    } else if (driver_options.tree_variant == TreeVariant::batch) {
+        const size_t batch_size = 65536;
+        ProgressReporter insert_progress("insert", total_operations, driver_options.progress_mode);
+        std::vector<int> batch_values;
+        for (size_t batch_begin = 0; batch_begin < total_operations; batch_begin += batch_size) {
+            size_t batch_end = std::min(batch_begin + batch_size, total_operations);
+            batch_values.assign(input_dataset.begin() + batch_begin, input_dataset.begin() + batch_end);
+            tree_state.node_count += insert_batch(tree_state.root_ptr, batch_values, tree_state.node_count);
+            insert_progress.record_operations(batch_end - batch_begin);
+        }
+        insert_progress.finish();
+        // insert_batch() bypasses insert_workload_key(), so drop any cached search results and fill the filter
+        tree_state.lookup_cache.clear();
+        if (tree_state.key_filter.is_enabled()) {
+            for (int key_value : input_dataset) {
+                tree_state.key_filter.insert_key(key_value);
+            }
+        }
+        if (tree_state.running_statistics.is_enabled()) {
+            for (int key_value : input_dataset) {
+                tree_state.running_statistics.record_insert(key_value);
+            }
+        }
+        console_output << "Inserted " << total_operations << " values in batches of " << batch_size << '\n';
+    } else if (total_operations <= detailed_insert_log_limit) {
+        for (size_t operation_index = 0; operation_index < total_operations; operation_index++) {
+            int current_value = input_dataset[operation_index];
+            
+            // Display current insertion operation
+            console_output << "Inserting node with value: " << PaddedInteger(current_value, 3) << " ";
+            
+            // Perform node insertion into binary search tree
+            tree_state.node_count += insert_workload_key(tree_state, current_value);
+            
+            // Display progress indicator for current operation
+            display_progress_indicator(console_output, operation_index + 1, total_operations);
+            console_output << '\n';
+        }
+    } else {
+        ProgressReporter insert_progress("insert", total_operations, driver_options.progress_mode);
+        for (int current_value : input_dataset) {
+            tree_state.node_count += insert_workload_key(tree_state, current_value);
+            insert_progress.record_operation();
+        }
+        insert_progress.finish();
+        console_output << "Inserted " << total_operations << " values\n";
+    }
+    
+    // Balanced variant restructures the finished tree in place
+    if (driver_options.tree_variant == TreeVariant::balanced) {
+        tree_state.root_ptr = rebalance_tree_in_place(tree_state.root_ptr);
+        console_output << "Rebalanced in place (Day-Stout-Warren)\n";
+    }
+    display_phase_timing(construction_timer);
+    metrics_recorder.record_integer("inserted_values", static_cast<long long>(total_operations));
+    metrics_recorder.record_integer("distinct_keys", static_cast<long long>(tree_state.node_count));
+    metrics_recorder.end_phase(construction_timer);
+    console_output.flush();
+    
+    // Fused mode: one walk feeds Phases 2, 3 and 5; it runs (and is timed) in the first of them enabled,
+    // which the others depend on in the phase graph
+    bool fused_analysis = driver_options.analysis_mode == AnalysisMode::fused;
+    TreeAnalysis tree_analysis;
+    bool tree_analysis_ready = false;
+    
+    // Concurrent phases share std::clock() and the ledger, so their timers report wall time only
+    PhaseTimerScope phase_timer_scope = driver_options.phase_schedule == PhaseSchedule::concurrent ? PhaseTimerScope::task
+                                                                                                   : PhaseTimerScope::process;
+    auto prepare_tree_analysis = [&]() {
+        if (tree_analysis_ready) {
+            return;
+        }
+        tree_analysis = analyze_tree_single_pass(tree_state.root_ptr, tree_state.node_count);
+        allocation_ledger.record_buffer_allocation((tree_analysis.inorder_keys.capacity() + tree_analysis.preorder_keys.capacity() +
+                                                    tree_analysis.postorder_keys.capacity()) * sizeof(int));
+        tree_analysis_ready = true;
+    };
+    
+    auto run_structure_phase = [&](FormattedOutputBuffer& phase_output, MetricsRecorder& phase_metrics) {
+        phase_output << "\nPhase 2: Tree Structure Analysis\n";
+        phase_output << "--------------------------------\n";
+        PhaseTimer analysis_timer(phase_timer_scope);
+        phase_metrics.begin_phase("structure");
+        
+        // Calculate and display tree metrics
+        int tree_height = 0;
+        int node_count = 0;
+        if (fused_analysis) {
+            prepare_tree_analysis();
+            tree_height = tree_analysis.tree_height;
+            node_count = static_cast<int>(tree_analysis.node_count);
+        } else {
+            tree_height = calculate_tree_height(tree_state.root_ptr);
+            node_count = count_total_nodes(tree_state.root_ptr);
+        }
+        
+        phase_output << "Tree Height (Maximum Depth): " << tree_height << '\n';
+        phase_output << "Total Node Count: " << node_count << '\n';
+        phase_output << "Tree Balance Factor: "
+                     << FixedPrecision(tree_height == 0 ? 0.0 : (double)node_count / (double)tree_height, 2) << '\n';
+        display_phase_timing(analysis_timer, phase_output);
+        phase_metrics.record_integer("height", tree_height);
+        phase_metrics.record_integer("node_count", node_count);
+        phase_metrics.end_phase(analysis_timer);
+        phase_output.flush();
+    };
+    
+    auto run_traversal_phase = [&](FormattedOutputBuffer& phase_output, MetricsRecorder& phase_metrics) {
+        phase_output << "\nPhase 3: Tree Traversal Operations\n";
+        phase_output << "----------------------------------\n";
+        PhaseTimer traversal_timer(phase_timer_scope);
+        phase_metrics.begin_phase("traversal");
+        
+        if (fused_analysis) {
+            // Print the buffers filled by the fused walk
+            prepare_tree_analysis();
+            display_traversal_results(tree_analysis.inorder_keys, "In-Order", driver_options.display_limit, phase_output);
+            display_traversal_results(tree_analysis.preorder_keys, "Pre-Order", driver_options.display_limit, phase_output);
+            display_traversal_results(tree_analysis.postorder_keys, "Post-Order", driver_options.display_limit, phase_output);
+        } else {
+            // Print each order straight from the tree; a walk stops once the display limit is reached
+            display_traversal_results(tree_state.root_ptr, TraversalOrder::inorder, tree_state.node_count,
+                                      "In-Order", driver_options.display_limit, phase_output);
+            display_traversal_results(tree_state.root_ptr, TraversalOrder::preorder, tree_state.node_count,
+                                      "Pre-Order", driver_options.display_limit, phase_output);
+            display_traversal_results(tree_state.root_ptr, TraversalOrder::postorder, tree_state.node_count,
+                                      "Post-Order", driver_options.display_limit, phase_output);
+        }
+        
+        display_phase_timing(traversal_timer, phase_output);
+        phase_metrics.record_integer("inorder_length", static_cast<long long>(tree_state.node_count));
+        phase_metrics.record_integer("preorder_length", static_cast<long long>(tree_state.node_count));
+        phase_metrics.record_integer("postorder_length", static_cast<long long>(tree_state.node_count));
+        phase_metrics.end_phase(traversal_timer);
+        phase_output.flush();
+    };
+    
+    auto run_search_phase = [&](FormattedOutputBuffer& phase_output, MetricsRecorder& phase_metrics) {
+        phase_output << "\nPhase 4: Search Operations and Validation\n";
+        phase_output << "----------------------------------------\n";
+        PhaseTimer search_timer(phase_timer_scope);
+        phase_metrics.begin_phase("search");
+        
+        // Test search functionality with various values
+        std::vector<int> search_targets = generate_search_targets(driver_options, input_dataset);
+        size_t found_count = 0;
+        
+        for (int target_value : search_targets) {
+            bool search_result = search_workload_key(tree_state, target_value);
+            found_count += search_result;
+            if (search_targets.size() <= detailed_insert_log_limit) {
+                phase_output << "Search for value " << PaddedInteger(target_value, 3) << ": " 
+                             << (search_result ? "FOUND" : "NOT FOUND") << '\n';
+            }
+        }
+        if (search_targets.size() > detailed_insert_log_limit) {
+            phase_output << "Searches: " << search_targets.size() << ", FOUND: " << found_count
+                         << ", NOT FOUND: " << (search_targets.size() - found_count) << '\n';
+        }
+        
+        // Cache effectiveness for tuning --lookup-cache
+        const HotKeyLookupCache& lookup_cache = tree_state.lookup_cache;
+        double cache_hit_rate = 0.0;
+        if (lookup_cache.is_enabled()) {
+            uint64_t cache_lookups = lookup_cache.hit_count() + lookup_cache.miss_count();
+            cache_hit_rate = cache_lookups == 0 ? 0.0 : 100.0 * lookup_cache.hit_count() / cache_lookups;
+            phase_output << "Lookup Cache: " << lookup_cache.set_count() << " sets x 2 ways, "
+                         << lookup_cache.hit_count() << " hits, " << lookup_cache.miss_count() << " misses ("
+                         << FixedPrecision(cache_hit_rate, 2) << "% hit rate)\n";
+            phase_output << "Lookup Latency (sampled): " << FixedPrecision(lookup_cache.mean_hit_nanoseconds(), 1)
+                         << " ns hit, " << FixedPrecision(lookup_cache.mean_miss_nanoseconds(), 1) << " ns miss\n";
+        }
+        
+        // Filter effectiveness: rejected misses never touch the tree
+        bool filter_report_enabled = tree_state.key_filter.is_enabled();
+        double filter_false_positive_rate = 0.0;
+        if (filter_report_enabled) {
+            uint64_t absent_lookups = tree_state.filter_rejections + tree_state.filter_false_positives;
+            filter_false_positive_rate = absent_lookups == 0 ? 0.0 : 100.0 * tree_state.filter_false_positives / absent_lookups;
+            phase_output << "Bloom Filter: " << tree_state.key_filter.memory_bytes() << " bytes, "
+                         << tree_state.filter_rejections << " misses rejected, "
+                         << tree_state.filter_false_positives << " false positives ("
+                         << FixedPrecision(filter_false_positive_rate, 2) << "% of misses)\n";
+        }
+        display_phase_timing(search_timer, phase_output);
+        phase_metrics.record_integer("searches", static_cast<long long>(search_targets.size()));
+        phase_metrics.record_integer("hits", static_cast<long long>(found_count));
+        phase_metrics.record_integer("misses", static_cast<long long>(search_targets.size() - found_count));
+        if (lookup_cache.is_enabled()) {
+            phase_metrics.record_integer("cache_sets", static_cast<long long>(lookup_cache.set_count()));
+            phase_metrics.record_integer("cache_hits", static_cast<long long>(lookup_cache.hit_count()));
+            phase_metrics.record_integer("cache_misses", static_cast<long long>(lookup_cache.miss_count()));
+            phase_metrics.record_decimal("cache_hit_rate_pct", cache_hit_rate);
+            phase_metrics.record_decimal("cache_hit_ns", lookup_cache.mean_hit_nanoseconds());
+            phase_metrics.record_decimal("cache_miss_ns", lookup_cache.mean_miss_nanoseconds());
+        }
+        if (filter_report_enabled) {
+            phase_metrics.record_integer("filter_bytes", static_cast<long long>(tree_state.key_filter.memory_bytes()));
+            phase_metrics.record_integer("filter_rejections", static_cast<long long>(tree_state.filter_rejections));
+            phase_metrics.record_integer("filter_false_positives", static_cast<long long>(tree_state.filter_false_positives));
+            phase_metrics.record_decimal("filter_false_positive_rate_pct", filter_false_positive_rate);
+        }
+        phase_metrics.end_phase(search_timer);
+        phase_output.flush();
+    };
+    
+    auto run_statistics_phase = [&](FormattedOutputBuffer& phase_output, MetricsRecorder& phase_metrics) {
+        phase_output << "\nPhase 5: Statistical Analysis\n";
+        phase_output << "----------------------------\n";
+        PhaseTimer statistics_timer(phase_timer_scope);
+        phase_metrics.begin_phase("statistics");
+        
+        DatasetStatistics dataset_statistics;
+        bool sketch_mode = driver_options.statistics_mode == StatisticsMode::sketch;
+        StreamingStatistics stream_statistics(driver_options.sketch_rank_error);
+        if (sketch_mode) {
+            // Sketch mode: summarize the raw key stream (duplicates included) in bounded memory; without a tree to
+            // build, the keys are generated and sketched one at a time on this thread
+            if (sketch_only) {
+                WorkloadKeyStream key_stream(driver_options);
+                int key_value;
+                while (key_stream.next_key(key_value)) {
+                    stream_statistics.record_value(key_value);
+                }
+            } else {
+                stream_statistics = summarize_key_stream(input_dataset, driver_options.sketch_rank_error);
+            }
+            dataset_statistics = stream_statistics.summary();
+            if (dataset_statistics.element_count == 0) {
+                phase_output << "No data available for statistical analysis.\n";
+            } else {
+                display_dataset_statistics(dataset_statistics, phase_output);
+                const KllQuantileSketch& quantile_sketch = stream_statistics.sketch();
+                phase_output << "Quantile Sketch: " << quantile_sketch.retained_item_count() << " retained values ("
+                             << quantile_sketch.retained_item_count() * sizeof(int) << " bytes), rank error within "
+                             << FixedPrecision(100.0 * quantile_sketch.rank_error_bound(), 2) << "% with high probability\n";
+            }
+        } else if (tree_state.running_statistics.is_enabled()) {
+            // Incremental mode: read the accumulator, no traversal
+            dataset_statistics = tree_state.running_statistics.current_statistics(tree_state.root_ptr);
+            if (dataset_statistics.element_count == 0) {
+                phase_output << "No data available for statistical analysis.\n";
+            } else {
+                display_dataset_statistics(dataset_statistics, phase_output);
+                phase_output << "Standard Deviation: "
+                             << FixedPrecision(tree_state.running_statistics.standard_deviation(), 2) << '\n';
+            }
+        } else if (fused_analysis) {
+            // Searches do not change the key set, so the fused walk's statistics still hold
+            prepare_tree_analysis();
+            dataset_statistics = tree_analysis.statistics;
+            if (dataset_statistics.element_count == 0) {
+                phase_output << "No data available for statistical analysis.\n";
+            } else {
+                display_dataset_statistics(dataset_statistics, phase_output);
+            }
+        } else {
+            // Perform comprehensive statistical analysis in one in-order walk of the tree
+            dataset_statistics = perform_statistical_analysis(tree_state.root_ptr, tree_state.node_count, phase_output);
+        }
+        
+        // Requested percentiles: O(log n) selects in incremental mode, otherwise one partial walk of the tree
+        std::vector<int> percentile_values;
+        const std::vector<double>& reported_percentiles = driver_options.reported_percentiles;
+        if (!reported_percentiles.empty() && dataset_statistics.element_count != 0) {
+            std::vector<double> requested_quantiles;
+            for (double percentile : reported_percentiles) {
+                requested_quantiles.push_back(percentile / 100.0);
+            }
+            if (sketch_mode) {
+                for (double quantile : requested_quantiles) {
+                    percentile_values.push_back(stream_statistics.sketch().quantile_value(quantile));
+                }
+            } else if (tree_state.running_statistics.is_enabled()) {
+                for (double quantile : requested_quantiles) {
+                    percentile_values.push_back(select_quantile(tree_state.running_statistics.order_statistics(), quantile));
+                }
+            } else {
+                percentile_values = tree_quantiles(tree_state.root_ptr, dataset_statistics.element_count, requested_quantiles);
+            }
+            phase_output << (sketch_mode ? "Percentiles (approximate):" : "Percentiles:");
+            for (size_t percentile_index = 0; percentile_index < percentile_values.size(); percentile_index++) {
+                phase_output << (percentile_index == 0 ? " p" : ", p") << reported_percentiles[percentile_index]
+                             << ' ' << percentile_values[percentile_index];
+            }
+            phase_output << '\n';
+        }
+        display_phase_timing(statistics_timer, phase_output);
+        record_dataset_statistics(dataset_statistics, phase_metrics);
+        if (tree_state.running_statistics.is_enabled()) {
+            phase_metrics.record_decimal("stddev", tree_state.running_statistics.standard_deviation());
+        }
+        if (sketch_mode) {
+            phase_metrics.record_integer("sketch_bytes", stream_statistics.sketch().retained_item_count() * sizeof(int));
+        }
+        for (size_t percentile_index = 0; percentile_index < percentile_values.size(); percentile_index++) {
+            char metric_name[32];   // 99.9 -> "p99_9"
+            std::snprintf(metric_name, sizeof(metric_name), "p%g", reported_percentiles[percentile_index]);
+            std::replace(metric_name, metric_name + std::strlen(metric_name), '.', '_');
+            phase_metrics.record_integer(metric_name, percentile_values[percentile_index]);
+        }
+        phase_metrics.end_phase(statistics_timer);
+        phase_output.flush();
+    };
+    
+    // Phases 2-5 as a task graph; tree access per phase decides what may overlap
+    bool splay_searches = driver_options.tree_variant == TreeVariant::splay;
+    bool threaded_percentiles = !driver_options.reported_percentiles.empty() &&
+                                (driver_options.statistics_mode == StatisticsMode::exact);
+    int fused_owner_phase = 0;   // First fused phase; it runs the walk the others read
+    if (fused_analysis) {
+        for (int phase_number : {2, 3, 5}) {
+            if (phase_is_enabled(driver_options, phase_number)) {
+                fused_owner_phase = phase_number;
+                break;
+            }
+        }
+    }
+    // Incremental statistics read the tree's edges for min/max, so only sketch mode and a fused walk that
+    // already ran leave Phase 5 off the tree entirely
+    TreeAccess statistics_access = TreeAccess::shared;
+    if (driver_options.statistics_mode == StatisticsMode::sketch) {
+        statistics_access = TreeAccess::none;
+    } else if (threaded_percentiles) {
+        statistics_access = TreeAccess::exclusive;
+    } else if (fused_analysis && fused_owner_phase != 5 && driver_options.statistics_mode != StatisticsMode::incremental) {
+        statistics_access = TreeAccess::none;
+    }
+    
+    // Concurrent phases render into captures that are committed in phase order afterwards
+    struct PhaseCapture {
+        FormattedOutputBuffer phase_output{-1};
+        MetricsRecorder phase_metrics;
+    };
+    bool concurrent_schedule = driver_options.phase_schedule == PhaseSchedule::concurrent;
+    PhaseCapture phase_captures[4];
+    std::vector<int> scheduled_phases;
+    PhaseTaskGraph phase_graph;
+    size_t fused_owner_task = SIZE_MAX;
+    auto schedule_phase = [&](int phase_number, const char* task_name, TreeAccess tree_access,
+                              const std::function<void(FormattedOutputBuffer&, MetricsRecorder&)>& phase_body) {
+        if (!phase_is_enabled(driver_options, phase_number)) {
+            return;
+        }
+        PhaseCapture* phase_capture = &phase_captures[phase_number - 2];
+        phase_capture->phase_metrics.configure_capture(driver_options.metrics_format);
+        std::vector<size_t> extra_dependencies;
+        if (fused_owner_task != SIZE_MAX) {
+            extra_dependencies.push_back(fused_owner_task);
+        }
+        size_t task_index = phase_graph.add_task(task_name, tree_access, [phase_capture, phase_body, concurrent_schedule]() {
+            if (concurrent_schedule) {
+                phase_body(phase_capture->phase_output, phase_capture->phase_metrics);
+            } else {
+                phase_body(console_output, metrics_recorder);
+            }
+        }, extra_dependencies);
+        if (phase_number == fused_owner_phase) {
+            fused_owner_task = task_index;
+        }
+        scheduled_phases.push_back(phase_number);
+    };
+    TreeAccess fused_reader_access = fused_analysis ? TreeAccess::none : TreeAccess::shared;
+    schedule_phase(2, "structure", fused_owner_phase == 2 ? TreeAccess::shared : fused_reader_access, run_structure_phase);
+    schedule_phase(3, "traversal", fused_owner_phase == 3 ? TreeAccess::shared : fused_reader_access, run_traversal_phase);
+    schedule_phase(4, "search", splay_searches ? TreeAccess::exclusive : TreeAccess::shared, run_search_phase);
+    schedule_phase(5, "statistics", statistics_access, run_statistics_phase);
+    
+    if (concurrent_schedule) {
+        unsigned schedule_threads = resolve_worker_thread_count(driver_options.thread_count);
+        PhaseTimer schedule_timer;
+        phase_graph.run_concurrent(schedule_threads);
+        double end_to_end_milliseconds = schedule_timer.wall_milliseconds();
+        for (int phase_number : scheduled_phases) {
+            phase_captures[phase_number - 2].phase_output.drain_into(console_output);
+            phase_captures[phase_number - 2].phase_metrics.commit_captured_records(metrics_recorder);
+        }
+        
+        // Serial equivalent: the phases' own wall times added up
+        double summed_phase_milliseconds = 0.0;
+        for (size_t task_index = 0; task_index < phase_graph.task_count(); task_index++) {
+            summed_phase_milliseconds += phase_graph.task_wall_milliseconds(task_index);
+        }
+        console_output << "\nPhase Schedule: " << phase_graph.task_count() << " phases on " << schedule_threads
+                       << " threads, " << FixedPrecision(end_to_end_milliseconds, 3) << " ms end-to-end vs "
+                       << FixedPrecision(summed_phase_milliseconds, 3) << " ms run back to back\n";
+        console_output.flush();
+        metrics_recorder.begin_phase("schedule");
+        metrics_recorder.record_integer("threads", schedule_threads);
+        metrics_recorder.record_decimal("end_to_end_ms", end_to_end_milliseconds);
+        metrics_recorder.record_decimal("summed_phase_ms", summed_phase_milliseconds);
+        metrics_recorder.end_phase(schedule_timer);
+    } else {
+        phase_graph.run_serial();
+    }
+    
+    // Teardown always runs; its report is optional
+    bool report_teardown = phase_is_enabled(driver_options, 6);
+    if (report_teardown) {
+        console_output << "\nPhase 6: Memory Management\n";
+        console_output << "-------------------------\n";
+    }
+    PhaseTimer teardown_timer;
+    metrics_recorder.begin_phase("teardown");
+    
+    // Deallocate all dynamically allocated memory
+    if (driver_options.tree_variant == TreeVariant::pooled) {
+        tree_state.node_pool.release_all_nodes();
+    } else {
+        deallocate_tree_memory(tree_state.root_ptr);
+    }
+    tree_state.root_ptr = nullptr;
+    allocation_ledger.record_buffer_release((tree_analysis.inorder_keys.capacity() + tree_analysis.preorder_keys.capacity() +
+                                             tree_analysis.postorder_keys.capacity()) * sizeof(int));
+    tree_analysis = TreeAnalysis();
+    
+    // Verify that every node allocation was returned
+    uint64_t leaked_node_count = allocation_ledger.live_nodes.load(std::memory_order_relaxed);
+    if (report_teardown) {
+        if (leaked_node_count == 0) {
+            console_output << "Tree memory successfully deallocated.\n";
+        } else {
+            console_output << "Memory leak detected: " << leaked_node_count << " nodes still live after teardown.\n";
+        }
+        console_output << "Live Nodes After Teardown: " << leaked_node_count << '\n';
+        console_output << "Peak Node Memory: " << allocation_ledger.peak_node_bytes.load(std::memory_order_relaxed) << " bytes\n";
+        console_output << "Node Allocation Calls: " << allocation_ledger.node_allocation_calls.load(std::memory_order_relaxed) << '\n';
+        console_output << "Peak Traversal Buffer Memory: " << allocation_ledger.peak_buffer_bytes.load(std::memory_order_relaxed) << " bytes\n";
+        console_output << "Resident Set Size: " << read_resident_memory_kib() << " KiB\n";
+        display_phase_timing(teardown_timer);
+    }
+    metrics_recorder.end_phase(teardown_timer);
+    if (leaked_node_count != 0) {
+        console_output.flush();
+        return 1;
+    }
+    
+    console_output << "\n========================================\n";
+    console_output << "   Binary Tree Demo Completed Successfully\n";
+    console_output << "   All operations executed without errors\n";
+    console_output << "========================================\n";
+    console_output.flush();
+    
+    return console_output.has_write_error() ? 1 : 0;
+}
+
+// Locate the child slot for a value: points at the matching node or at the empty insertion slot
+static TreeNode** locate_insertion_slot(TreeNode** root_slot_ptr, int insertion_value) {
+    TreeNode** insertion_slot_ptr = root_slot_ptr;
+    
+    while (*insertion_slot_ptr != nullptr) {
+        TreeNode* current_node_ptr = *insertion_slot_ptr;
+        
+        // Navigate left subtree for smaller values
+        if (insertion_value < current_node_ptr->data_payload) {
+            insertion_slot_ptr = &current_node_ptr->left_child_ptr;
+        }
+        // Navigate right subtree for larger values
+        else if (insertion_value > current_node_ptr->data_payload) {
+            insertion_slot_ptr = &current_node_ptr->right_child_ptr;
+        }
+        // Duplicate value found: slot refers to the existing node
+        else {
+            break;
+        }
+    }
+    
+    return insertion_slot_ptr;
+}
+
+// Iterative insertion function for binary search tree construction
+TreeNode* insert_node_iterative(TreeNode* root_ptr, int insertion_value) {
+    insert_node_unique(root_ptr, insertion_value);
+    return root_ptr;
+}
+
+// Insert a value, allocating only once the slot is confirmed empty; returns true when the key was new
+bool insert_node_unique(TreeNode*& root_ptr, int insertion_value) {
+    TreeNode** insertion_slot_ptr = locate_insertion_slot(&root_ptr, insertion_value);
+    
+    // Duplicate values are ignored without touching the allocator
+    if (*insertion_slot_ptr != nullptr) {
+        return false;
+    }
+    
+    *insertion_slot_ptr = new TreeNode(insertion_value);
+    return true;
+}
+
+// Multiset insertion: duplicates bump the per-key occurrence count; returns true when the key was new
+bool insert_node_counting(TreeNode*& root_ptr, int insertion_value) {
+    TreeNode** insertion_slot_ptr = locate_insertion_slot(&root_ptr, insertion_value);
+    
+    if (*insertion_slot_ptr != nullptr) {
+        (*insertion_slot_ptr)->occurrence_count++;
+        return false;
+    }
+    
+    *insertion_slot_ptr = new TreeNode(insertion_value);
+    return true;
+}
+
+// Number of times a value was inserted in counting mode (0 when absent)
+unsigned count_key_occurrences(TreeNode* root_ptr, int target_value) {
+    TreeNode** matching_slot_ptr = locate_insertion_slot(&root_ptr, target_value);
+    return *matching_slot_ptr != nullptr ? (*matching_slot_ptr)->occurrence_count : 0;
+}
+
+// Collect inorder traversal (Left-Root-Right) into a vector
+void perform_inorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
+    visit_inorder(current_node, [&traversal_results](int key_value) {
+        traversal_results.push_back(key_value);
+        return true;
+    });
+}
+
+// Collect preorder traversal (Root-Left-Right) into a vector
+void perform_preorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
+    visit_preorder(current_node, [&traversal_results](int key_value) {
+        traversal_results.push_back(key_value);
+        return true;
+    });
+}
+
+// Collect postorder traversal (Left-Right-Root) into a vector
+void perform_postorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
+    visit_postorder(current_node, [&traversal_results](int key_value) {
+        traversal_results.push_back(key_value);
+        return true;
+    });
+}
+
+// Iterative inorder traversal implementation (Left-Root-Right) using an explicit stack
+template <typename KeyVisitor> bool visit_inorder(TreeNode* current_node, KeyVisitor&& key_visitor) {
+    std::vector<TreeNode*> pending_nodes;
+    TraversalStackCharge stack_charge(pending_nodes);
+    
+    while (current_node != nullptr || !pending_nodes.empty()) {
+        // Descend the left spine, remembering each ancestor
+        while (current_node != nullptr) {
+            pending_nodes.push_back(current_node);
+            current_node = current_node->left_child_ptr;
+        }
+        
+        // Process current node data, then continue with its right subtree
+        current_node = pending_nodes.back();
+        pending_nodes.pop_back();
+        if (!key_visitor(current_node->data_payload)) {
+            return false;
+        }
+        current_node = current_node->right_child_ptr;
+    }
+    return true;
+}
+
+// Iterative preorder traversal implementation (Root-Left-Right) using an explicit stack
+template <typename KeyVisitor> bool visit_preorder(TreeNode* current_node, KeyVisitor&& key_visitor) {
+    std::vector<TreeNode*> pending_nodes;
+    TraversalStackCharge stack_charge(pending_nodes);
+    if (current_node != nullptr) {
+        pending_nodes.push_back(current_node);
+    }
+    
+    while (!pending_nodes.empty()) {
+        current_node = pending_nodes.back();
+        pending_nodes.pop_back();
+        
+        // Process current node data first
+        if (!key_visitor(current_node->data_payload)) {
+            return false;
+        }
+        
+        // Push right before left so the left subtree is processed first
+        if (current_node->right_child_ptr != nullptr) {
+            pending_nodes.push_back(current_node->right_child_ptr);
+        }
+        if (current_node->left_child_ptr != nullptr) {
+            pending_nodes.push_back(current_node->left_child_ptr);
+        }
+    }
+    return true;
+}
+
+// Iterative postorder traversal implementation (Left-Right-Root) using an explicit stack
+template <typename KeyVisitor> bool visit_postorder(TreeNode* current_node, KeyVisitor&& key_visitor) {
+    std::vector<TreeNode*> pending_nodes;
+    TraversalStackCharge stack_charge(pending_nodes);
+    TreeNode* last_visited_ptr = nullptr;
+    
+    while (current_node != nullptr || !pending_nodes.empty()) {
+        // Descend the left spine, remembering each ancestor
+        while (current_node != nullptr) {
+            pending_nodes.push_back(current_node);
+            current_node = current_node->left_child_ptr;
+        }
+        
+        // Visit the right subtree first if it has not been processed yet
+        TreeNode* top_node_ptr = pending_nodes.back();
+        if (top_node_ptr->right_child_ptr != nullptr && top_node_ptr->right_child_ptr != last_visited_ptr) {
+            current_node = top_node_ptr->right_child_ptr;
+        }
+        // Both subtrees done: process current node data last
+        else {
+            if (!key_visitor(top_node_ptr->data_payload)) {
+                return false;
+            }
+            last_visited_ptr = top_node_ptr;
+            pending_nodes.pop_back();
+        }
+    }
+    return true;
+}
+
+// Dispatch to the requested order; each branch instantiates its own inlined visitor
+template <typename KeyVisitor> bool visit_tree(TreeNode* root_ptr, TraversalOrder traversal_order, KeyVisitor&& key_visitor) {
+    switch (traversal_order) {
+        case TraversalOrder::preorder:
+            return visit_preorder(root_ptr, key_visitor);
+        case TraversalOrder::postorder:
+            return visit_postorder(root_ptr, key_visitor);
+        case TraversalOrder::inorder:
+        default:
+            return visit_inorder(root_ptr, key_visitor);
+    }
+}
+
+// Calculate maximum height of binary tree with an explicit depth-tracking stack
+int calculate_tree_height(TreeNode* current_node) {
+    std::vector<std::pair<TreeNode*, int>> pending_nodes;
+    int maximum_depth = 0;
+    if (current_node != nullptr) {
+        pending_nodes.emplace_back(current_node, 1);
+    }
+    
+    while (!pending_nodes.empty()) {
+        std::pair<TreeNode*, int> pending_entry = pending_nodes.back();
+        pending_nodes.pop_back();
+        maximum_depth = std::max(maximum_depth, pending_entry.second);
+        
+        if (pending_entry.first->left_child_ptr != nullptr) {
+            pending_nodes.emplace_back(pending_entry.first->left_child_ptr, pending_entry.second + 1);
+        }
+        if (pending_entry.first->right_child_ptr != nullptr) {
+            pending_nodes.emplace_back(pending_entry.first->right_child_ptr, pending_entry.second + 1);
+        }
+    }
+    
+    return maximum_depth;
+}
+
+// Count total number of nodes in binary tree with an explicit stack
+int count_total_nodes(TreeNode* current_node) {
+    std::vector<TreeNode*> pending_nodes;
+    int node_total = 0;
+    if (current_node != nullptr) {
+        pending_nodes.push_back(current_node);
+    }
+    
+    while (!pending_nodes.empty()) {
+        current_node = pending_nodes.back();
+        pending_nodes.pop_back();
+        node_total++;
+        
+        if (current_node->left_child_ptr != nullptr) {
+            pending_nodes.push_back(current_node->left_child_ptr);
+        }
+        if (current_node->right_child_ptr != nullptr) {
+            pending_nodes.push_back(current_node->right_child_ptr);
+        }
+    }
+    
+    return node_total;
+}
+
+// Search for specific value in binary search tree
+bool search_node_value(TreeNode* current_node, int target_value) {
+    // Iterative descent; speculation past the compare lets the next node's load start early
+    while (current_node != nullptr && current_node->data_payload != target_value) {
+        current_node = target_value < current_node->data_payload ? current_node->left_child_ptr
+                                                                 : current_node->right_child_ptr;
+    }
+    return current_node != nullptr;
+}
+
+// Branch-free variant kept for comparison; --benchmark branchless measures it slower than search_node_value()
+bool search_node_value_branchless(TreeNode* current_node, int target_value) {
+    // Descend to a leaf remembering the last node whose key is >= target; both children are loaded and one
+    // is kept by masking their addresses, so the only branch is the predictable loop exit
+    TreeNode* candidate_node_ptr = nullptr;
+    while (current_node != nullptr) {
+        bool descend_right = current_node->data_payload < target_value;
+        uintptr_t right_mask = 0 - static_cast<uintptr_t>(descend_right);
+        candidate_node_ptr = descend_right ? candidate_node_ptr : current_node;
+        current_node = reinterpret_cast<TreeNode*>((reinterpret_cast<uintptr_t>(current_node->left_child_ptr) & ~right_mask) |
+                                                   (reinterpret_cast<uintptr_t>(current_node->right_child_ptr) & right_mask));
+    }
+    
+    // Target value found when the smallest key >= target equals it
+    return candidate_node_ptr != nullptr && candidate_node_ptr->data_payload == target_value;
+}
+
+// Detach the node holding a key without freeing it; returns nullptr when absent
+TreeNode* unlink_node_value(TreeNode*& root_ptr, int target_value) {
+    // Find the link that points at the node to remove
+    TreeNode** parent_link_ptr = &root_ptr;
+    while (*parent_link_ptr != nullptr && (*parent_link_ptr)->data_payload != target_value) {
+        TreeNode* current_node_ptr = *parent_link_ptr;
+        parent_link_ptr = target_value < current_node_ptr->data_payload ? &current_node_ptr->left_child_ptr
+                                                                      : &current_node_ptr->right_child_ptr;
+    }
+    TreeNode* removed_node_ptr = *parent_link_ptr;
+    if (removed_node_ptr == nullptr) {
+        return nullptr;
+    }
+    
+    if (removed_node_ptr->left_child_ptr == nullptr) {
+        *parent_link_ptr = removed_node_ptr->right_child_ptr;
+    } else if (removed_node_ptr->right_child_ptr == nullptr) {
+        *parent_link_ptr = removed_node_ptr->left_child_ptr;
+    } else {
+        // Two children: splice out the in-order successor and move it into the removed node's place
+        TreeNode** successor_link_ptr = &removed_node_ptr->right_child_ptr;
+        while ((*successor_link_ptr)->left_child_ptr != nullptr) {
+            successor_link_ptr = &(*successor_link_ptr)->left_child_ptr;
+        }
+        TreeNode* successor_node_ptr = *successor_link_ptr;
+        *successor_link_ptr = successor_node_ptr->right_child_ptr;
+        successor_node_ptr->left_child_ptr = removed_node_ptr->left_child_ptr;
+        successor_node_ptr->right_child_ptr = removed_node_ptr->right_child_ptr;
+        *parent_link_ptr = successor_node_ptr;
+    }
+    return removed_node_ptr;
+}
+
+// Remove a key from a heap-allocated tree (all occurrences in counting mode); returns false when absent
+bool delete_node_value(TreeNode*& root_ptr, int target_value) {
+    TreeNode* removed_node_ptr = unlink_node_value(root_ptr, target_value);
+    delete removed_node_ptr;
+    return removed_node_ptr != nullptr;
+}
+
+// Display visual progress indicator for operations
+void display_progress_indicator(FormattedOutputBuffer& output, uint64_t current_step, uint64_t total_steps) {
+    const int progress_bar_width = 20;
+    uint64_t filled_segments = total_steps == 0 ? progress_bar_width : (current_step * progress_bar_width) / total_steps;
+    
+    // Render the whole bar in one append instead of one insertion per segment
+    char progress_bar_text[progress_bar_width + 2];
+    progress_bar_text[0] = '[';
+    for (int segment_index = 0; segment_index < progress_bar_width; segment_index++) {
+        progress_bar_text[segment_index + 1] = static_cast<uint64_t>(segment_index) < filled_segments ? '=' : ' ';
+    }
+    progress_bar_text[progress_bar_width + 1] = ']';
+    
+    output.append_text(progress_bar_text, sizeof(progress_bar_text));
+    output << ' ' << PaddedInteger(total_steps == 0 ? 100 : static_cast<long long>((current_step * 100) / total_steps), 3) << "%";
+}
+
+// Reporter constructor resolves the output mode and starts the redraw thread
+ProgressReporter::ProgressReporter(const std::string& phase_label, uint64_t total_operations,
+                                   ProgressOutputMode output_mode, std::chrono::milliseconds report_interval)
+    : phase_name(phase_label), operation_total(total_operations), resolved_mode(output_mode),
+      interval_duration(report_interval), start_time(std::chrono::steady_clock::now()),
+      completed_operations(0), report_output(2, 4096), stop_requested(false) {
+    if (resolved_mode == ProgressOutputMode::automatic) {
+        resolved_mode = isatty(2) ? ProgressOutputMode::terminal : ProgressOutputMode::silent;
+    }
+    if (resolved_mode != ProgressOutputMode::silent) {
+        reporter_thread = std::thread(&ProgressReporter::reporter_loop, this);
+    }
+}
+
+// Reporter destructor makes sure the thread is stopped
+ProgressReporter::~ProgressReporter() {
+    finish();
+}
+
+// Stop the redraw thread and emit the final report
+void ProgressReporter::finish() {
+    {
+        std::lock_guard<std::mutex> state_lock(state_mutex);
+        if (stop_requested) {
+            return;
+        }
+        stop_requested = true;
+    }
+    stop_signal.notify_one();
+    if (reporter_thread.joinable()) {
+        reporter_thread.join();
+        render_report(true);
+    }
+}
+
+// Wake every interval (or on finish) and redraw
+void ProgressReporter::reporter_loop() {
+    std::unique_lock<std::mutex> state_lock(state_mutex);
+    while (!stop_signal.wait_for(state_lock, interval_duration, [this] { return stop_requested; })) {
+        state_lock.unlock();
+        render_report(false);
+        state_lock.lock();
+    }
+}
+
+// Format one report with completion, throughput (ops/sec) and ETA
+void ProgressReporter::render_report(bool final_report) {
+    uint64_t completed_count = completed_operations.load(std::memory_order_relaxed);
+    double elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    double operations_per_second = elapsed_seconds > 0.0 ? completed_count / elapsed_seconds : 0.0;
+    double remaining_seconds = (operations_per_second > 0.0 && operation_total > completed_count)
+        ? (operation_total - completed_count) / operations_per_second : 0.0;
+    
+    if (resolved_mode == ProgressOutputMode::terminal) {
+        report_output << '\r' << phase_name << ' ';
+        display_progress_indicator(report_output, completed_count, operation_total);
+        report_output << "  " << FixedPrecision(operations_per_second, 0) << " ops/s  ETA "
+                      << FixedPrecision(remaining_seconds, 1) << "s   ";
+        if (final_report) {
+            report_output << '\n';
+        }
+    } else {
+        report_output << "progress phase=" << phase_name << " done=" << completed_count
+                      << " total=" << operation_total << " ops_per_sec=" << FixedPrecision(operations_per_second, 0)
+                      << " eta_s=" << FixedPrecision(remaining_seconds, 3) << " final=" << (final_report ? 1 : 0) << '\n';
+    }
+    report_output.flush();
+}
+
+// Shared traversal formatting; walk_keys(visitor) feeds keys until the visitor returns false
+template <typename KeyWalk>
+static void display_key_sequence(KeyWalk&& walk_keys, size_t element_count, const std::string& traversal_type,
+                                 size_t display_limit, FormattedOutputBuffer& output) {
+    output << traversal_type << " Traversal: ";
+    size_t displayed_count = std::min(element_count, display_limit);
+    
+    size_t element_index = 0;
+    walk_keys([&](int key_value) {
+        if (element_index == displayed_count) {
+            return false;
+        }
+        output << key_value;
+        if (element_index < element_count - 1) {
+            output << " -> ";
+        }
+        element_index++;
+        return true;
+    });
+    
+    // Long traversals are truncated to keep the report readable
+    if (displayed_count < element_count) {
+        output << "... (" << element_count << " elements)";
+    }
+    output << '\n';
+}
+
+// Display formatted traversal results with professional presentation, walking the tree directly
+void display_traversal_results(TreeNode* root_ptr, TraversalOrder traversal_order, size_t element_count,
+                               const std::string& traversal_type, size_t display_limit, FormattedOutputBuffer& output) {
+    display_key_sequence([&](auto&& key_visitor) { visit_tree(root_ptr, traversal_order, key_visitor); },
+                         element_count, traversal_type, display_limit, output);
+}
+
+// Display formatted traversal results from a collected buffer
+void display_traversal_results(const std::vector<int>& results, const std::string& traversal_type,
+                               size_t display_limit, FormattedOutputBuffer& output) {
+    display_key_sequence([&](auto&& key_visitor) {
+        for (int key_value : results) {
+            if (!key_visitor(key_value)) {
+                break;
+            }
+        }
+    }, results.size(), traversal_type, display_limit, output);
+}
+
+// Perform comprehensive statistical analysis over the tree
+DatasetStatistics perform_statistical_analysis(TreeNode* root_ptr, size_t node_count, FormattedOutputBuffer& output) {
+    DatasetStatistics statistics = compute_tree_statistics(root_ptr, node_count);
+    if (statistics.element_count == 0) {
+        output << "No data available for statistical analysis.\n";
+        return statistics;
+    }
+    
+    display_dataset_statistics(statistics, output);
+    return statistics;
+}
+
+// Compute sum, mean, median, extremes and range for a dataset
+DatasetStatistics compute_dataset_statistics(const std::vector<int>& dataset) {
+    DatasetStatistics statistics;
+    if (dataset.empty()) {
+        return statistics;
+    }
+    statistics.element_count = dataset.size();
+    
+    // Calculate sum and mean value (64-bit to hold large generated workloads)
+    for (int value : dataset) {
+        statistics.sum_total += value;
+    }
+    statistics.mean_value = static_cast<double>(statistics.sum_total) / dataset.size();
+    
+    // Find minimum and maximum values
+    statistics.minimum_value = *std::min_element(dataset.begin(), dataset.end());
+    statistics.maximum_value = *std::max_element(dataset.begin(), dataset.end());
+    
+    // Calculate range and median
+    statistics.value_range = static_cast<long long>(statistics.maximum_value) - statistics.minimum_value;
+    std::vector<int> sorted_dataset = dataset;
+    radix_sort_keys(sorted_dataset);
+    statistics.median_value = (sorted_dataset.size() % 2 == 0) ?
+        (static_cast<double>(sorted_dataset[sorted_dataset.size()/2 - 1]) + sorted_dataset[sorted_dataset.size()/2]) / 2.0 :
+        sorted_dataset[sorted_dataset.size()/2];
+    
+    return statistics;
+}
+
+// Same fields as compute_dataset_statistics() in one in-order walk: keys arrive sorted, so the
+// extremes are the first and last keys and the median sits at a known position (node_count must be exact)
+DatasetStatistics compute_tree_statistics(TreeNode* root_ptr, size_t node_count) {
+    DatasetStatistics statistics;
+    if (root_ptr == nullptr || node_count == 0) {
+        return statistics;
+    }
+    size_t lower_median_index = (node_count - 1) / 2;
+    size_t upper_median_index = node_count / 2;
+    int lower_median_value = 0;
+    int upper_median_value = 0;
+    size_t key_index = 0;
+    
+    visit_inorder(root_ptr, [&](int key_value) {
+        if (key_index == 0) {
+            statistics.minimum_value = key_value;
+        }
+        if (key_index == lower_median_index) {
+            lower_median_value = key_value;
+        }
+        if (key_index == upper_median_index) {
+            upper_median_value = key_value;
+        }
+        statistics.maximum_value = key_value;
+        statistics.sum_total += key_value;
+        key_index++;
+        return true;
+    });
+    
+    statistics.element_count = key_index;
+    statistics.mean_value = static_cast<double>(statistics.sum_total) / key_index;
+    statistics.median_value = (static_cast<double>(lower_median_value) + upper_median_value) / 2.0;
+    statistics.value_range = static_cast<long long>(statistics.maximum_value) - statistics.minimum_value;
+    return statistics;
+}
+
+// One explicit-stack walk emitting all three orders: pre-order on the way down, in-order on
+// returning from the left subtree, post-order on returning from the right; buffers are reserved up front
+TreeAnalysis analyze_tree_single_pass(TreeNode* root_ptr, size_t expected_node_count) {
+    TreeAnalysis tree_analysis;
+    tree_analysis.inorder_keys.reserve(expected_node_count);
+    tree_analysis.preorder_keys.reserve(expected_node_count);
+    tree_analysis.postorder_keys.reserve(expected_node_count);
+    
+    std::vector<std::pair<TreeNode*, int>> pending_nodes;   // Ancestor and its depth
+    TreeNode* current_node = root_ptr;
+    TreeNode* last_visited_ptr = nullptr;
+    int current_depth = 1;
+    long long key_sum = 0;
+    
+    while (current_node != nullptr || !pending_nodes.empty()) {
+        // Descend the left spine: pre-order position, depth for the height
+        while (current_node != nullptr) {
+            tree_analysis.preorder_keys.push_back(current_node->data_payload);
+            tree_analysis.tree_height = std::max(tree_analysis.tree_height, current_depth);
+            pending_nodes.emplace_back(current_node, current_depth);
+            current_node = current_node->left_child_ptr;
+            current_depth++;
+        }
+        
+        TreeNode* top_node_ptr = pending_nodes.back().first;
+        TreeNode* right_child_ptr = top_node_ptr->right_child_ptr;
+        if (right_child_ptr == nullptr || right_child_ptr != last_visited_ptr) {
+            // Left subtree finished: in-order position
+            tree_analysis.inorder_keys.push_back(top_node_ptr->data_payload);
+            key_sum += top_node_ptr->data_payload;
+        }
+        if (right_child_ptr != nullptr && right_child_ptr != last_visited_ptr) {
+            current_node = right_child_ptr;
+            current_depth = pending_nodes.back().second + 1;
+        }
+        // Both subtrees finished: post-order position
+        else {
+            tree_analysis.postorder_keys.push_back(top_node_ptr->data_payload);
+            last_visited_ptr = top_node_ptr;
+            pending_nodes.pop_back();
+        }
+    }
+    
+    // In-order keys are sorted: extremes and median are positional, no second scan or sort
+    const std::vector<int>& sorted_keys = tree_analysis.inorder_keys;
+    tree_analysis.node_count = sorted_keys.size();
+    if (!sorted_keys.empty()) {
+        DatasetStatistics& statistics = tree_analysis.statistics;
+        statistics.element_count = sorted_keys.size();
+        statistics.sum_total = key_sum;
+        statistics.mean_value = static_cast<double>(key_sum) / sorted_keys.size();
+        statistics.median_value = (static_cast<double>(sorted_keys[(sorted_keys.size() - 1) / 2]) + sorted_keys[sorted_keys.size() / 2]) / 2.0;
+        statistics.minimum_value = sorted_keys.front();
+        statistics.maximum_value = sorted_keys.back();
+        statistics.value_range = static_cast<long long>(statistics.maximum_value) - statistics.minimum_value;
+    }
+    return tree_analysis;
+}
+
+// Cross-check a fused analysis against the separate per-phase functions
+bool tree_analysis_matches(TreeNode* root_ptr, const TreeAnalysis& tree_analysis) {
+    std::vector<int> inorder_results;
+    std::vector<int> preorder_results;
+    std::vector<int> postorder_results;
+    perform_inorder_traversal(root_ptr, inorder_results);
+    perform_preorder_traversal(root_ptr, preorder_results);
+    perform_postorder_traversal(root_ptr, postorder_results);
+    DatasetStatistics expected_statistics = compute_dataset_statistics(inorder_results);
+    const DatasetStatistics& fused_statistics = tree_analysis.statistics;
+    
+    return tree_analysis.tree_height == calculate_tree_height(root_ptr) &&
+           tree_analysis.node_count == static_cast<size_t>(count_total_nodes(root_ptr)) &&
+           tree_analysis.inorder_keys == inorder_results &&
+           tree_analysis.preorder_keys == preorder_results &&
+           tree_analysis.postorder_keys == postorder_results &&
+           fused_statistics.element_count == expected_statistics.element_count &&
+           fused_statistics.sum_total == expected_statistics.sum_total &&
+           fused_statistics.mean_value == expected_statistics.mean_value &&
+           fused_statistics.median_value == expected_statistics.median_value &&
+           fused_statistics.minimum_value == expected_statistics.minimum_value &&
+           fused_statistics.maximum_value == expected_statistics.maximum_value &&
+           fused_statistics.value_range == expected_statistics.value_range;
+}
+
+// Display statistical metrics
+void display_dataset_statistics(const DatasetStatistics& statistics, FormattedOutputBuffer& output) {
+    output << "Dataset Size: " << statistics.element_count << " elements\n";
+    output << "Sum Total: " << statistics.sum_total << '\n';
+    output << "Mean Value: " << FixedPrecision(statistics.mean_value, 2) << '\n';
+    output << (statistics.median_is_estimate ? "Median Value (approximate): " : "Median Value: ")
+           << FixedPrecision(statistics.median_value, 2) << '\n';
+    output << "Minimum Value: " << statistics.minimum_value << '\n';
+    output << "Maximum Value: " << statistics.maximum_value << '\n';
+    output << "Value Range: " << statistics.value_range << '\n';
+}
+
+// Forward Phase 5 statistics to the metrics emitter
+void record_dataset_statistics(const DatasetStatistics& statistics, MetricsRecorder& recorder) {
+    if (!recorder.is_enabled()) {
+        return;
+    }
+    recorder.record_integer("count", static_cast<long long>(statistics.element_count));
+    recorder.record_integer("sum", statistics.sum_total);
+    recorder.record_decimal("mean", statistics.mean_value);
+    recorder.record_decimal("median", statistics.median_value);
+    recorder.record_integer("min", statistics.minimum_value);
+    recorder.record_integer("max", statistics.maximum_value);
+    recorder.record_integer("range", statistics.value_range);
+}
+
+// Move the finger to the deepest path entry whose subtree range admits the key, then descend
+static TreeNode** descend_from_finger(TreeNode*& root_ptr, TreeFinger& access_finger, int target_value) {
+    // Restart from the root when the finger is empty or belongs to another tree
+    if (access_finger.access_path.empty() || access_finger.access_path.front().node_ptr != root_ptr) {
+        access_finger.reset();
+        if (root_ptr == nullptr) {
+            return &root_ptr;
+        }
+        access_finger.access_path.push_back({root_ptr, LLONG_MIN, LLONG_MAX});
+    }
+    
+    // Climb only while the key lies outside the current subtree's bounds
+    while (access_finger.access_path.size() > 1 &&
+           (target_value <= access_finger.access_path.back().lower_bound ||
+            target_value >= access_finger.access_path.back().upper_bound)) {
+        access_finger.access_path.pop_back();
+    }
+    
+    // Descend from there, extending the path with tightened bounds
+    for (;;) {
+        TreeFinger::PathEntry current_entry = access_finger.access_path.back();
+        TreeNode* current_node_ptr = current_entry.node_ptr;
+        
+        if (target_value == current_node_ptr->data_payload) {
+            return nullptr;
+        }
+        
+        TreeNode** child_slot_ptr = target_value < current_node_ptr->data_payload
+            ? &current_node_ptr->left_child_ptr : &current_node_ptr->right_child_ptr;
+        if (*child_slot_ptr == nullptr) {
+            return child_slot_ptr;
+        }
+        
+        if (target_value < current_node_ptr->data_payload) {
+            access_finger.access_path.push_back({*child_slot_ptr, current_entry.lower_bound, current_node_ptr->data_payload});
+        } else {
+            access_finger.access_path.push_back({*child_slot_ptr, current_node_ptr->data_payload, current_entry.upper_bound});
+        }
+    }
+}
+
+// Finger search: O(log d) on balanced trees where d is the key distance from the previous access
+bool finger_search(TreeNode* root_ptr, TreeFinger& access_finger, int target_value) {
+    return descend_from_finger(root_ptr, access_finger, target_value) == nullptr && root_ptr != nullptr;
+}
+
+// Hinted insert from the finger; returns true when the key was new and leaves the finger on it
+bool finger_insert(TreeNode*& root_ptr, TreeFinger& access_finger, int insertion_value) {
+    TreeNode** insertion_slot_ptr = descend_from_finger(root_ptr, access_finger, insertion_value);
+    if (insertion_slot_ptr == nullptr) {
+        return false;
+    }
+    
+    *insertion_slot_ptr = new TreeNode(insertion_value);
+    
+    // First node becomes the root entry; otherwise extend the path to the new leaf
+    if (access_finger.access_path.empty()) {
+        access_finger.access_path.push_back({root_ptr, LLONG_MIN, LLONG_MAX});
+    } else {
+        TreeFinger::PathEntry parent_entry = access_finger.access_path.back();
+        if (insertion_value < parent_entry.node_ptr->data_payload) {
+            access_finger.access_path.push_back({*insertion_slot_ptr, parent_entry.lower_bound, parent_entry.node_ptr->data_payload});
+        } else {
+            access_finger.access_path.push_back({*insertion_slot_ptr, parent_entry.node_ptr->data_payload, parent_entry.upper_bound});
+        }
+    }
+    return true;
+}
+
+// Top-down splay (Sleator-Tarjan): brings the key, or the last node on its search path, to the root
+TreeNode* splay_tree_access(TreeNode* root_ptr, int target_value) {
+    if (root_ptr == nullptr) {
+        return nullptr;
+    }
+    
+    // Header collects the left tree (keys < target) and right tree (keys > target) without parent pointers
+    TreeNode assembly_header(0);
+    TreeNode* left_tree_max_ptr = &assembly_header;
+    TreeNode* right_tree_min_ptr = &assembly_header;
+    TreeNode* current_node_ptr = root_ptr;
+    
+    for (;;) {
+        if (target_value < current_node_ptr->data_payload) {
+            if (current_node_ptr->left_child_ptr == nullptr) {
+                break;
+            }
+            // Zig-zig: rotate right before linking
+            if (target_value < current_node_ptr->left_child_ptr->data_payload) {
+                TreeNode* rotated_node_ptr = current_node_ptr->left_child_ptr;
+                current_node_ptr->left_child_ptr = rotated_node_ptr->right_child_ptr;
+                rotated_node_ptr->right_child_ptr = current_node_ptr;
+                current_node_ptr = rotated_node_ptr;
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    break;
+                }
+            }
+            // Link right: current node joins the right tree
+            right_tree_min_ptr->left_child_ptr = current_node_ptr;
+            right_tree_min_ptr = current_node_ptr;
+            current_node_ptr = current_node_ptr->left_child_ptr;
+        } else if (target_value > current_node_ptr->data_payload) {
+            if (current_node_ptr->right_child_ptr == nullptr) {
+                break;
+            }
+            // Zig-zig: rotate left before linking
+            if (target_value > current_node_ptr->right_child_ptr->data_payload) {
+                TreeNode* rotated_node_ptr = current_node_ptr->right_child_ptr;
+                current_node_ptr->right_child_ptr = rotated_node_ptr->left_child_ptr;
+                rotated_node_ptr->left_child_ptr = current_node_ptr;
+                current_node_ptr = rotated_node_ptr;
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    break;
+                }
+            }
+            // Link left: current node joins the left tree
+            left_tree_max_ptr->right_child_ptr = current_node_ptr;
+            left_tree_max_ptr = current_node_ptr;
+            current_node_ptr = current_node_ptr->right_child_ptr;
+        } else {
+            break;
+        }
+    }
+    
+    // Reassemble: left tree, current node, right tree
+    left_tree_max_ptr->right_child_ptr = current_node_ptr->left_child_ptr;
+    right_tree_min_ptr->left_child_ptr = current_node_ptr->right_child_ptr;
+    current_node_ptr->left_child_ptr = assembly_header.right_child_ptr;
+    current_node_ptr->right_child_ptr = assembly_header.left_child_ptr;
+    return current_node_ptr;
+}
+
+// Self-adjusting search: the accessed key (or its neighbour) becomes the new root
+bool splay_search(TreeNode*& root_ptr, int target_value) {
+    root_ptr = splay_tree_access(root_ptr, target_value);
+    return root_ptr != nullptr && root_ptr->data_payload == target_value;
+}
+
+// Self-adjusting insert: splay, then split the tree around the new root; returns true when the key was new
+bool splay_insert(TreeNode*& root_ptr, int insertion_value) {
+    root_ptr = splay_tree_access(root_ptr, insertion_value);
+    if (root_ptr != nullptr && root_ptr->data_payload == insertion_value) {
+        return false;
+    }
+    
+    TreeNode* new_node_ptr = new TreeNode(insertion_value);
+    if (root_ptr != nullptr) {
+        if (insertion_value < root_ptr->data_payload) {
+            new_node_ptr->left_child_ptr = root_ptr->left_child_ptr;
+            new_node_ptr->right_child_ptr = root_ptr;
+            root_ptr->left_child_ptr = nullptr;
+        } else {
+            new_node_ptr->right_child_ptr = root_ptr->right_child_ptr;
+            new_node_ptr->left_child_ptr = root_ptr;
+            root_ptr->right_child_ptr = nullptr;
+        }
+    }
+    root_ptr = new_node_ptr;
+    return true;
+}
+
+// Iterative memory deallocation using right rotations (O(1) extra space, no recursion)
+void deallocate_tree_memory(TreeNode* current_node) {
+    while (current_node != nullptr) {
+        // Rotate left child up so the current node loses its left subtree
+        if (current_node->left_child_ptr != nullptr) {
+            TreeNode* left_child_ptr = current_node->left_child_ptr;
+            current_node->left_child_ptr = left_child_ptr->right_child_ptr;
+            left_child_ptr->right_child_ptr = current_node;
+            current_node = left_child_ptr;
+        }
+        // No left subtree remains: free the node and continue down the right spine
+        else {
+            TreeNode* right_child_ptr = current_node->right_child_ptr;
+            delete current_node;
+            current_node = right_child_ptr;
+        }
+    }
+}
+
+// Hand tree teardown to a background thread; caller waits on the future when convenient
+std::future<void> deallocate_tree_memory_async(TreeNode* root_ptr) {
+    return std::async(std::launch::async, deallocate_tree_memory, root_ptr);
+}
+
+// Raise a high-water mark to at least candidate_value
+static void raise_watermark(std::atomic<uint64_t>& watermark, uint64_t candidate_value) {
+    uint64_t observed_value = watermark.load(std::memory_order_relaxed);
+    while (observed_value < candidate_value &&
+           !watermark.compare_exchange_weak(observed_value, candidate_value, std::memory_order_relaxed)) {
+    }
+}
+
+void AllocationLedger::record_node_allocation(uint64_t node_count, uint64_t byte_count, uint64_t call_count) {
+    live_nodes.fetch_add(node_count, std::memory_order_relaxed);
+    node_allocation_calls.fetch_add(call_count, std::memory_order_relaxed);
+    if (byte_count != 0) {
+        uint64_t current_bytes = node_bytes.fetch_add(byte_count, std::memory_order_relaxed) + byte_count;
+        raise_watermark(peak_node_bytes, current_bytes);
+        raise_watermark(phase_peak_node_bytes, current_bytes);
+    }
+}
+
+void AllocationLedger::record_node_release(uint64_t node_count, uint64_t byte_count, uint64_t call_count) {
+    live_nodes.fetch_sub(node_count, std::memory_order_relaxed);
+    node_bytes.fetch_sub(byte_count, std::memory_order_relaxed);
+    node_release_calls.fetch_add(call_count, std::memory_order_relaxed);
+}
+
+void AllocationLedger::record_buffer_allocation(uint64_t byte_count) {
+    uint64_t current_bytes = buffer_bytes.fetch_add(byte_count, std::memory_order_relaxed) + byte_count;
+    raise_watermark(peak_buffer_bytes, current_bytes);
+}
+
+void AllocationLedger::record_buffer_release(uint64_t byte_count) {
+    buffer_bytes.fetch_sub(byte_count, std::memory_order_relaxed);
+}
+
+// The stack is freed right after, so it raises the buffer watermark without staying in buffer_bytes
+TraversalStackCharge::~TraversalStackCharge() {
+    uint64_t stack_bytes = pending_nodes.capacity() * sizeof(TreeNode*);
+    allocation_ledger.record_buffer_allocation(stack_bytes);
+    allocation_ledger.record_buffer_release(stack_bytes);
+}
+
+// Phase peaks restart from the current footprint
+void AllocationLedger::begin_phase() {
+    phase_peak_node_bytes.store(node_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// Counted node allocation
+void* TreeNode::operator new(size_t byte_count) {
+    void* node_storage = ::operator new(byte_count);
+    allocation_ledger.record_node_allocation(1, byte_count, 1);
+    return node_storage;
+}
+
+// Counted node release
+void TreeNode::operator delete(void* node_ptr, size_t byte_count) noexcept {
+    allocation_ledger.record_node_release(1, byte_count, 1);
+    ::operator delete(node_ptr);
+}
+
+// Pool constructor records the block granularity for node carving
+TreeNodePool::TreeNodePool(size_t nodes_per_block)
+    : block_capacity(nodes_per_block == 0 ? 1 : nodes_per_block), current_block_used(0), live_node_count(0) {}
+
+// Pool destructor releases every block still held
+TreeNodePool::~TreeNodePool() {
+    release_all_nodes();
+}
+
+// Carve a node from the current block, starting a new block when it is full
+TreeNode* TreeNodePool::allocate_node(int value) {
+    if (storage_blocks.empty() || current_block_used == block_capacity) {
+        storage_blocks.push_back(static_cast<TreeNode*>(::operator new(block_capacity * sizeof(TreeNode))));
+        current_block_used = 0;
+        allocation_ledger.record_node_allocation(0, block_capacity * sizeof(TreeNode), 1);
+    }
+    allocation_ledger.record_node_allocation(1, 0, 0);
+    
+    TreeNode* node_ptr = ::new (storage_blocks.back() + current_block_used) TreeNode(value);
+    current_block_used++;
+    live_node_count++;
+    return node_ptr;
+}
+
+// Bulk release: TreeNode is trivially destructible so whole blocks are returned at once
+void TreeNodePool::release_all_nodes() {
+    for (TreeNode* block_ptr : storage_blocks) {
+        ::operator delete(block_ptr);
+    }
+    allocation_ledger.record_node_release(live_node_count, storage_blocks.size() * block_capacity * sizeof(TreeNode),
+                                          storage_blocks.size());
+    storage_blocks.clear();
+    current_block_used = 0;
+    live_node_count = 0;
+}
+
+// Number of nodes handed out since the last bulk release
+size_t TreeNodePool::allocated_node_count() const {
+    return live_node_count;
+}
+
+// Iterative insertion drawing the new node from a pool once the slot is confirmed
+TreeNode* insert_node_pooled(TreeNode* root_ptr, int insertion_value, TreeNodePool& node_pool) {
+    TreeNode** insertion_slot_ptr = locate_insertion_slot(&root_ptr, insertion_value);
+    
+    if (*insertion_slot_ptr == nullptr) {
+        *insertion_slot_ptr = node_pool.allocate_node(insertion_value);
+    }
+    return root_ptr;
+}
+
+// Straighten the tree into a right-leaning vine using right rotations
+static size_t convert_tree_to_vine(TreeNode* pseudo_root_ptr) {
+    TreeNode* vine_tail_ptr = pseudo_root_ptr;
+    TreeNode* remainder_ptr = vine_tail_ptr->right_child_ptr;
+    size_t vine_length = 0;
+    
+    while (remainder_ptr != nullptr) {
+        // Node without left child extends the vine
+        if (remainder_ptr->left_child_ptr == nullptr) {
+            vine_tail_ptr = remainder_ptr;
+            remainder_ptr = remainder_ptr->right_child_ptr;
+            vine_length++;
+        }
+        // Rotate the left child up into the vine position
+        else {
+            TreeNode* rotated_node_ptr = remainder_ptr->left_child_ptr;
+            remainder_ptr->left_child_ptr = rotated_node_ptr->right_child_ptr;
+            rotated_node_ptr->right_child_ptr = remainder_ptr;
+            remainder_ptr = rotated_node_ptr;
+            vine_tail_ptr->right_child_ptr = rotated_node_ptr;
+        }
+    }
+    
+    return vine_length;
+}
+
+// Perform a sequence of left rotations along the vine spine
+static void compress_vine(TreeNode* pseudo_root_ptr, size_t rotation_count) {
+    TreeNode* scanner_ptr = pseudo_root_ptr;
+    
+    for (size_t rotation_index = 0; rotation_index < rotation_count; rotation_index++) {
+        TreeNode* child_node_ptr = scanner_ptr->right_child_ptr;
+        scanner_ptr->right_child_ptr = child_node_ptr->right_child_ptr;
+        scanner_ptr = scanner_ptr->right_child_ptr;
+        child_node_ptr->right_child_ptr = scanner_ptr->left_child_ptr;
+        scanner_ptr->left_child_ptr = child_node_ptr;
+    }
+}
+
+// In-place Day-Stout-Warren rebalancing reusing existing nodes with O(1) extra memory
+TreeNode* rebalance_tree_in_place(TreeNode* root_ptr) {
+    // Temporary pseudo-root simplifies rotations at the real root
+    TreeNode pseudo_root(0);
+    pseudo_root.right_child_ptr = root_ptr;
+    
+    size_t node_total = convert_tree_to_vine(&pseudo_root);
+    
+    // Largest complete tree size not exceeding node_total
+    size_t complete_tree_size = 1;
+    while (complete_tree_size <= node_total + 1) {
+        complete_tree_size <<= 1;
+    }
+    complete_tree_size = (complete_tree_size >> 1) - 1;
+    
+    // Place surplus nodes on the bottom level, then fold the vine repeatedly
+    compress_vine(&pseudo_root, node_total - complete_tree_size);
+    while (complete_tree_size > 1) {
+        complete_tree_size >>= 1;
+        compress_vine(&pseudo_root, complete_tree_size);
+    }
+    
+    return pseudo_root.right_child_ptr;
+}
+
+// Build height-balanced tree from sorted values in range [range_begin, range_end)
+TreeNode* build_balanced_tree(const std::vector<int>& sorted_values, size_t range_begin, size_t range_end) {
+    if (range_begin >= range_end) {
+        return nullptr;
+    }
+    
+    size_t middle_index = range_begin + (range_end - range_begin) / 2;
+    TreeNode* subtree_root_ptr = new TreeNode(sorted_values[middle_index]);
+    subtree_root_ptr->left_child_ptr = build_balanced_tree(sorted_values, range_begin, middle_index);
+    subtree_root_ptr->right_child_ptr = build_balanced_tree(sorted_values, middle_index + 1, range_end);
+    
+    return subtree_root_ptr;
+}
+
+// Merge a sorted, deduplicated batch range into a subtree, visiting each node at most once
+static size_t merge_sorted_batch(TreeNode*& subtree_root_ptr, const std::vector<int>& batch_values,
+                                 size_t range_begin, size_t range_end) {
+    if (range_begin >= range_end) {
+        return 0;
+    }
+    
+    // Empty slot: the remaining range becomes a balanced subtree
+    if (subtree_root_ptr == nullptr) {
+        subtree_root_ptr = build_balanced_tree(batch_values, range_begin, range_end);
+        return range_end - range_begin;
+    }
+    
+    // Partition the range around this node and drop a matching key
+    int pivot_value = subtree_root_ptr->data_payload;
+    size_t split_index = std::lower_bound(batch_values.begin() + range_begin, batch_values.begin() + range_end,
+                                          pivot_value) - batch_values.begin();
+    size_t right_begin = split_index;
+    if (right_begin < range_end && batch_values[right_begin] == pivot_value) {
+        right_begin++;
+    }
+    
+    return merge_sorted_batch(subtree_root_ptr->left_child_ptr, batch_values, range_begin, split_index) +
+           merge_sorted_batch(subtree_root_ptr->right_child_ptr, batch_values, right_begin, range_end);
+}
+
+// Merge a sorted batch into the vine, reusing vine nodes and allocating only for new keys
+static size_t merge_batch_into_vine(TreeNode* pseudo_root_ptr, const std::vector<int>& batch_values) {
+    TreeNode* vine_tail_ptr = pseudo_root_ptr;
+    size_t batch_index = 0;
+    size_t inserted_count = 0;
+    
+    while (batch_index < batch_values.size()) {
+        TreeNode* next_vine_ptr = vine_tail_ptr->right_child_ptr;
+        int batch_value = batch_values[batch_index];
+        
+        // Existing key: advance past it, skipping an equal batch value
+        if (next_vine_ptr != nullptr && next_vine_ptr->data_payload <= batch_value) {
+            if (next_vine_ptr->data_payload == batch_value) {
+                batch_index++;
+            }
+            vine_tail_ptr = next_vine_ptr;
+        }
+        // New key: splice a node in front of the next vine node
+        else {
+            TreeNode* new_node_ptr = new TreeNode(batch_value);
+            new_node_ptr->right_child_ptr = next_vine_ptr;
+            vine_tail_ptr->right_child_ptr = new_node_ptr;
+            vine_tail_ptr = new_node_ptr;
+            batch_index++;
+            inserted_count++;
+        }
+    }
+    
+    return inserted_count;
+}
+
+// Batch insertion: sort and dedup, then merge in one coordinated descent or by vine merge and rebuild
+size_t insert_batch(TreeNode*& root_ptr, std::vector<int>& batch_values, size_t tree_node_count) {
+    const size_t batch_rebuild_ratio = 4;
+    
+    radix_sort_keys(batch_values, 1);
+    batch_values.erase(std::unique(batch_values.begin(), batch_values.end()), batch_values.end());
+    
+    // Small batch relative to the tree: single coordinated descent
+    if (batch_values.size() * batch_rebuild_ratio < tree_node_count) {
+        return merge_sorted_batch(root_ptr, batch_values, 0, batch_values.size());
+    }
+    
+    // Large batch: flatten to a sorted vine, merge sequences, fold back into a balanced tree
+    TreeNode pseudo_root(0);
+    pseudo_root.right_child_ptr = root_ptr;
+    size_t vine_length = convert_tree_to_vine(&pseudo_root);
+    size_t inserted_count = merge_batch_into_vine(&pseudo_root, batch_values);
+    
+    size_t complete_tree_size = 1;
+    while (complete_tree_size <= vine_length + inserted_count + 1) {
+        complete_tree_size <<= 1;
+    }
+    complete_tree_size = (complete_tree_size >> 1) - 1;
+    
+    compress_vine(&pseudo_root, vine_length + inserted_count - complete_tree_size);
+    while (complete_tree_size > 1) {
+        complete_tree_size >>= 1;
+        compress_vine(&pseudo_root, complete_tree_size);
+    }
+    
+    root_ptr = pseudo_root.right_child_ptr;
+    return inserted_count;
+}
+
+// LSD radix sort on 8-bit digits for 32/64-bit keys; signed keys are ordered by flipping the sign bit
+template <typename KeyType>
+void radix_sort_keys(std::vector<KeyType>& keys, unsigned thread_count) {
+    static_assert(std::is_integral<KeyType>::value && (sizeof(KeyType) == 4 || sizeof(KeyType) == 8),
+                  "radix_sort_keys supports 32-bit and 64-bit integer keys");
+    using UnsignedKey = typename std::make_unsigned<KeyType>::type;
+    const unsigned digit_bits = 8;
+    const unsigned bucket_count = 1u << digit_bits;
+    const unsigned pass_count = sizeof(KeyType) * 8 / digit_bits;
+    const UnsignedKey sign_flip_mask = std::is_signed<KeyType>::value
+        ? static_cast<UnsignedKey>(UnsignedKey(1) << (sizeof(KeyType) * 8 - 1)) : UnsignedKey(0);
+    const size_t minimum_keys_per_thread = 1 << 16;
+    
+    // Small inputs are cheaper with a comparison sort
+    if (keys.size() < 256) {
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+    
+    // Resolve worker count, keeping every chunk large enough to amortize thread start-up
+    thread_count = resolve_worker_thread_count(thread_count);
+    thread_count = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(thread_count, keys.size() / minimum_keys_per_thread)));
+    
+    std::vector<KeyType> scratch_keys(keys.size());
+    std::vector<size_t> chunk_bounds(thread_count + 1);
+    for (unsigned thread_index = 0; thread_index <= thread_count; thread_index++) {
+        chunk_bounds[thread_index] = keys.size() * thread_index / thread_count;
+    }
+    
+    // Run a callable on every chunk, in parallel when more than one worker is configured
+    auto run_on_chunks = [&](auto&& chunk_work) {
+        if (thread_count == 1) {
+            chunk_work(0u);
+            return;
+        }
+        std::vector<std::thread> worker_threads;
+        for (unsigned thread_index = 0; thread_index < thread_count; thread_index++) {
+            worker_threads.emplace_back(chunk_work, thread_index);
+        }
+        for (std::thread& worker_thread : worker_threads) {
+            worker_thread.join();
+        }
+    };
+    
+    // Per-thread histograms for every digit, gathered in a single read of the input
+    std::vector<size_t> digit_histograms(static_cast<size_t>(thread_count) * pass_count * bucket_count, 0);
+    run_on_chunks([&](unsigned thread_index) {
+        size_t* thread_histograms = &digit_histograms[static_cast<size_t>(thread_index) * pass_count * bucket_count];
+        for (size_t key_index = chunk_bounds[thread_index]; key_index < chunk_bounds[thread_index + 1]; key_index++) {
+            UnsignedKey ordered_key = static_cast<UnsignedKey>(keys[key_index]) ^ sign_flip_mask;
+            for (unsigned pass_index = 0; pass_index < pass_count; pass_index++) {
+                thread_histograms[pass_index * bucket_count + ((ordered_key >> (pass_index * digit_bits)) & (bucket_count - 1))]++;
+            }
+        }
+    });
+    
+    KeyType* source_keys = keys.data();
+    KeyType* destination_keys = scratch_keys.data();
+    std::vector<size_t> scatter_offsets(static_cast<size_t>(thread_count) * bucket_count);
+    
+    for (unsigned pass_index = 0; pass_index < pass_count; pass_index++) {
+        unsigned digit_shift = pass_index * digit_bits;
+        
+        // Skip digits shared by every key (common for small-range 64-bit keys)
+        bool digit_is_uniform = false;
+        for (unsigned bucket_index = 0; bucket_index < bucket_count && !digit_is_uniform; bucket_index++) {
+            size_t bucket_total = 0;
+            for (unsigned thread_index = 0; thread_index < thread_count; thread_index++) {
+                bucket_total += digit_histograms[(static_cast<size_t>(thread_index) * pass_count + pass_index) * bucket_count + bucket_index];
+            }
+            digit_is_uniform = bucket_total == keys.size();
+        }
+        if (digit_is_uniform) {
+            continue;
+        }
+        
+        // Chunk-major prefix sums keep the scatter stable across threads
+        size_t running_offset = 0;
+        for (unsigned bucket_index = 0; bucket_index < bucket_count; bucket_index++) {
+            for (unsigned thread_index = 0; thread_index < thread_count; thread_index++) {
+                scatter_offsets[static_cast<size_t>(thread_index) * bucket_count + bucket_index] = running_offset;
+                running_offset += digit_histograms[(static_cast<size_t>(thread_index) * pass_count + pass_index) * bucket_count + bucket_index];
+            }
+        }
+        
+        // Each thread scatters its chunk to its reserved bucket ranges
+        run_on_chunks([&](unsigned thread_index) {
+            size_t* thread_offsets = &scatter_offsets[static_cast<size_t>(thread_index) * bucket_count];
+            for (size_t key_index = chunk_bounds[thread_index]; key_index < chunk_bounds[thread_index + 1]; key_index++) {
+                KeyType key_value = source_keys[key_index];
+                unsigned bucket_index = ((static_cast<UnsignedKey>(key_value) ^ sign_flip_mask) >> digit_shift) & (bucket_count - 1);
+                destination_keys[thread_offsets[bucket_index]++] = key_value;
+            }
+        });
+        std::swap(source_keys, destination_keys);
+        
+        // Chunk membership changed, so later digits need fresh per-thread histograms
+        if (thread_count > 1) {
+            run_on_chunks([&](unsigned thread_index) {
+                size_t* thread_histograms = &digit_histograms[static_cast<size_t>(thread_index) * pass_count * bucket_count];
+                std::fill(thread_histograms + (pass_index + 1) * bucket_count, thread_histograms + pass_count * bucket_count, 0);
+                for (size_t key_index = chunk_bounds[thread_index]; key_index < chunk_bounds[thread_index + 1]; key_index++) {
+                    UnsignedKey ordered_key = static_cast<UnsignedKey>(source_keys[key_index]) ^ sign_flip_mask;
+                    for (unsigned later_pass = pass_index + 1; later_pass < pass_count; later_pass++) {
+                        thread_histograms[later_pass * bucket_count + ((ordered_key >> (later_pass * digit_bits)) & (bucket_count - 1))]++;
+                    }
+                }
+            });
+        }
+    }
+    
+    // An odd number of executed passes leaves the result in the scratch buffer
+    if (source_keys != keys.data()) {
+        keys.swap(scratch_keys);
+    }
+}
+
+// Output buffer constructor sizes the reusable render buffer once
+FormattedOutputBuffer::FormattedOutputBuffer(int file_descriptor, size_t buffer_capacity)
+    : buffer_storage(std::max<size_t>(buffer_capacity, 64)), used_bytes(0), output_descriptor(file_descriptor) {}
+
+// Output buffer destructor writes any remaining rendered bytes
+FormattedOutputBuffer::~FormattedOutputBuffer() {
+    flush();
+}
+
+// Make room for byte_count more bytes, writing the current chunk out (or growing a capture) when needed
+void FormattedOutputBuffer::reserve_space(size_t byte_count) {
+    if (used_bytes + byte_count > buffer_storage.size()) {
+        if (output_descriptor < 0) {
+            buffer_storage.resize(std::max(buffer_storage.size() * 2, used_bytes + byte_count));
+            return;
+        }
+        flush();
+    }
+}
+
+// Copy raw text, streaming oversized inputs through the buffer chunk by chunk
+FormattedOutputBuffer& FormattedOutputBuffer::append_text(const char* text, size_t length) {
+    if (output_descriptor < 0) {
+        reserve_space(length);
+    }
+    while (length > 0) {
+        if (used_bytes == buffer_storage.size()) {
+            flush();
+        }
+        size_t copy_length = std::min(length, buffer_storage.size() - used_bytes);
+        std::memcpy(buffer_storage.data() + used_bytes, text, copy_length);
+        used_bytes += copy_length;
+        text += copy_length;
+        length -= copy_length;
+    }
+    return *this;
+}
+
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(const char* text) {
+    return append_text(text, std::strlen(text));
+}
+
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(const std::string& text) {
+    return append_text(text.data(), text.size());
+}
+
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(char character) {
+    reserve_space(1);
+    buffer_storage[used_bytes++] = character;
+    return *this;
+}
+
+// Doubles use six significant digits, matching default iostream formatting
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(double value) {
+    reserve_space(32);
+    char* format_end = std::to_chars(buffer_storage.data() + used_bytes, buffer_storage.data() + buffer_storage.size(),
+                                     value, std::chars_format::general, 6).ptr;
+    used_bytes = format_end - buffer_storage.data();
+    return *this;
+}
+
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(const FixedPrecision& request) {
+    char format_storage[352];
+    std::to_chars_result format_result = std::to_chars(format_storage, format_storage + sizeof(format_storage),
+                                                       request.value, std::chars_format::fixed, request.precision);
+    return append_text(format_storage, format_result.ptr - format_storage);
+}
+
+FormattedOutputBuffer& FormattedOutputBuffer::operator<<(const PaddedInteger& request) {
+    char format_storage[24];
+    size_t format_length = std::to_chars(format_storage, format_storage + sizeof(format_storage), request.value).ptr - format_storage;
+    for (int pad_index = static_cast<int>(format_length); pad_index < request.width; pad_index++) {
+        *this << ' ';
+    }
+    return append_text(format_storage, format_length);
+}
+
+// Hand captured text to another buffer, in order
+void FormattedOutputBuffer::drain_into(FormattedOutputBuffer& destination_output) {
+    destination_output.append_text(buffer_storage.data(), used_bytes);
+    used_bytes = 0;
+}
+
+// Emit the rendered chunk with as few write() calls as the kernel allows; captures keep their text
+void FormattedOutputBuffer::flush() {
+    if (output_descriptor < 0) {
+        return;
+    }
+    size_t written_bytes = 0;
+    while (written_bytes < used_bytes) {
+#ifdef _WIN32
+        int write_result = _write(output_descriptor, buffer_storage.data() + written_bytes,
+                                  static_cast<unsigned>(used_bytes - written_bytes));
+#else
+        ssize_t write_result = write(output_descriptor, buffer_storage.data() + written_bytes, used_bytes - written_bytes);
+#endif
+        if (write_result < 0 && errno == EINTR) {
+            continue;   // Interrupted before anything was written: retry the same range
+        }
+        if (write_result <= 0) {
+            write_failed = true;   // Closed pipe, full disk, bad descriptor: nothing more can be written
+            break;
+        }
+        written_bytes += static_cast<size_t>(write_result);   // Short writes loop for the remainder
+    }
+    used_bytes = 0;
+}
+
+// Resolve a requested worker count: explicit value, else --threads, else hardware concurrency
+unsigned resolve_worker_thread_count(unsigned requested_threads) {
+    if (requested_threads == 0) {
+        requested_threads = configured_worker_threads;
+    }
+    if (requested_threads == 0) {
+        requested_threads = std::thread::hardware_concurrency();
+    }
+    return std::max(1u, requested_threads);
+}
+
+// Read a kB-valued field (e.g. "VmRSS", "VmHWM") from /proc/self/status; -1 if unavailable
+long read_process_memory_kib(const std::string& status_field) {
+    std::ifstream status_stream("/proc/self/status");
+    std::string line_text;
+    
+    while (std::getline(status_stream, line_text)) {
+        if (line_text.compare(0, status_field.size(), status_field) == 0 &&
+            line_text.size() > status_field.size() && line_text[status_field.size()] == ':') {
+            return std::strtol(line_text.c_str() + status_field.size() + 1, nullptr, 10);
+        }
+    }
+    return -1;
+}
+
+// Current resident set size from /proc/self/statm (second field, in pages); -1 if unavailable
+long read_resident_memory_kib() {
+    std::ifstream statm_stream("/proc/self/statm");
+    long total_pages = 0;
+    long resident_pages = 0;
+    if (!(statm_stream >> total_pages >> resident_pages)) {
+        return -1;
+    }
+#ifdef _WIN32
+    return -1;
+#else
+    return resident_pages * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+}
+
+// Reset the kernel peak RSS watermark (VmHWM) so each benchmark measures its own peak
+void reset_peak_memory_watermark() {
+    std::ofstream clear_refs_stream("/proc/self/clear_refs");
+    clear_refs_stream << "5";
+}
+
+// Dispatch benchmark mode: --benchmark <name> [node_count ...]
+int run_benchmark_command(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --benchmark <rebalance|teardown|batch|radix|output|finger|splay|cache|bloom|branchless|snapshot|setops|reshard|stats|quantiles|sketch|visitor|fused|threaded> [node_count ...]\n";
+        return 1;
+    }
+    
+    std::string benchmark_name = argv[2];
+    std::vector<size_t> node_counts;
+    for (int argument_index = 3; argument_index < argc; argument_index++) {
+        node_counts.push_back(std::strtoull(argv[argument_index], nullptr, 10));
+    }
+    
+    if (benchmark_name == "rebalance") {
+        if (node_counts.empty()) {
+            node_counts = {10000000, 100000000};
+        }
+        for (size_t node_count : node_counts) {
+            run_rebalance_benchmark(node_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "teardown") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t node_count : node_counts) {
+            run_teardown_benchmark(node_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "batch") {
+        if (node_counts.empty()) {
+            node_counts = {10000000};
+        }
+        for (size_t node_count : node_counts) {
+            run_batch_insert_benchmark(node_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "radix") {
+        if (node_counts.empty()) {
+            node_counts = {100000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_radix_sort_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "output") {
+        if (node_counts.empty()) {
+            node_counts = {10000000};
+        }
+        for (size_t element_count : node_counts) {
+            run_output_benchmark(element_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "finger") {
+        if (node_counts.empty()) {
+            node_counts = {50000};
+        }
+        for (size_t key_count : node_counts) {
+            run_finger_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "threaded") {
+        if (node_counts.empty()) {
+            node_counts = {1000, 100000, 1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_threaded_tree_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "fused") {
+        if (node_counts.empty()) {
+            node_counts = {1000, 100000, 1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_fused_analysis_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "visitor") {
+        if (node_counts.empty()) {
+            node_counts = {1000, 100000, 1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_visitor_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "sketch") {
+        if (node_counts.empty()) {
+            node_counts = {100000000};
+        }
+        for (size_t value_count : node_counts) {
+            run_sketch_benchmark(value_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "quantiles") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_quantile_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "stats") {
+        if (node_counts.empty()) {
+            node_counts = {200000};
+        }
+        for (size_t key_count : node_counts) {
+            run_incremental_statistics_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "reshard") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_reshard_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "setops") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_set_operation_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "snapshot") {
+        if (node_counts.empty()) {
+            node_counts = {200000};
+        }
+        for (size_t key_count : node_counts) {
+            run_snapshot_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "branchless") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_branchless_search_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "bloom") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_bloom_filter_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "cache") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_lookup_cache_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    if (benchmark_name == "splay") {
+        if (node_counts.empty()) {
+            node_counts = {1000000};
+        }
+        for (size_t key_count : node_counts) {
+            run_splay_benchmark(key_count);
+        }
+        return 0;
+    }
+    
+    std::cerr << "Unknown benchmark: " << benchmark_name << "\n";
+    return 1;
+}
+
+// Build a random-key tree of the requested size for benchmarking
+static TreeNode* build_random_benchmark_tree(size_t node_count, unsigned random_seed) {
+    std::mt19937 random_engine(random_seed);
+    std::uniform_int_distribution<int> key_distribution(0, 2000000000);
+    TreeNode* root_ptr = nullptr;
+    
+    for (size_t insertion_index = 0; insertion_index < node_count; insertion_index++) {
+        root_ptr = insert_node_iterative(root_ptr, key_distribution(random_engine));
+    }
+    return root_ptr;
+}
+
+// Compare DSW in-place rebalance against rebuild-from-traversal (time and peak RSS)
+void run_rebalance_benchmark(size_t node_count) {
+    console_output << "Rebalance benchmark with " << node_count << " insertions\n";
+    
+    // Strategy 1: in-place Day-Stout-Warren
+    TreeNode* tree_root_ptr = build_random_benchmark_tree(node_count, 26);
+    long baseline_rss_kib = read_process_memory_kib("VmRSS");
+    reset_peak_memory_watermark();
+    auto start_time = std::chrono::steady_clock::now();
+    tree_root_ptr = rebalance_tree_in_place(tree_root_ptr);
+    auto stop_time = std::chrono::steady_clock::now();
+    long peak_rss_kib = read_process_memory_kib("VmHWM");
+    
+    console_output << "  DSW in-place:          "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms, "
+                   << "height " << calculate_tree_height(tree_root_ptr) << ", "
+                   << "peak RSS growth " << (peak_rss_kib - baseline_rss_kib) << " KiB\n";
+    deallocate_tree_memory(tree_root_ptr);
+    
+    // Strategy 2: collect in-order values, rebuild, free the old tree
+    tree_root_ptr = build_random_benchmark_tree(node_count, 26);
+    baseline_rss_kib = read_process_memory_kib("VmRSS");
+    reset_peak_memory_watermark();
+    start_time = std::chrono::steady_clock::now();
+    std::vector<int> sorted_values;
+    perform_inorder_traversal(tree_root_ptr, sorted_values);
+    TreeNode* rebuilt_root_ptr = build_balanced_tree(sorted_values, 0, sorted_values.size());
+    deallocate_tree_memory(tree_root_ptr);
+    stop_time = std::chrono::steady_clock::now();
+    peak_rss_kib = read_process_memory_kib("VmHWM");
+    
+    console_output << "  Rebuild-from-traversal: "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms, "
+                   << "height " << calculate_tree_height(rebuilt_root_ptr) << ", "
+                   << "peak RSS growth " << (peak_rss_kib - baseline_rss_kib) << " KiB\n";
+    deallocate_tree_memory(rebuilt_root_ptr);
+}
+
+// Build a degenerate right-leaning chain of sorted keys (shape produced by sorted inserts)
+static TreeNode* build_sorted_chain_tree(size_t node_count, TreeNodePool* node_pool) {
+    TreeNode* root_ptr = nullptr;
+    TreeNode** tail_slot_ptr = &root_ptr;
+    
+    for (size_t key_index = 0; key_index < node_count; key_index++) {
+        int key_value = static_cast<int>(key_index);
+        *tail_slot_ptr = node_pool ? node_pool->allocate_node(key_value) : new TreeNode(key_value);
+        tail_slot_ptr = &(*tail_slot_ptr)->right_child_ptr;
+    }
+    return root_ptr;
+}
+
+// Compare per-node teardown, pool bulk release and background teardown latency
+void run_teardown_benchmark(size_t node_count) {
+    console_output << "Teardown benchmark with " << node_count << " nodes (degenerate and random shapes)\n";
+    
+    // Degenerate sorted chain: previously overflowed the stack in the recursive version
+    TreeNode* tree_root_ptr = build_sorted_chain_tree(node_count, nullptr);
+    auto start_time = std::chrono::steady_clock::now();
+    deallocate_tree_memory(tree_root_ptr);
+    auto stop_time = std::chrono::steady_clock::now();
+    console_output << "  Iterative delete (sorted chain): "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    
+    // Random shape freed node by node
+    tree_root_ptr = build_random_benchmark_tree(node_count, 27);
+    start_time = std::chrono::steady_clock::now();
+    deallocate_tree_memory(tree_root_ptr);
+    stop_time = std::chrono::steady_clock::now();
+    console_output << "  Iterative delete (random):       "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    
+    // Random shape drawn from a pool and released in bulk
+    {
+        TreeNodePool node_pool;
+        std::mt19937 random_engine(27);
+        std::uniform_int_distribution<int> key_distribution(0, 2000000000);
+        tree_root_ptr = nullptr;
+        for (size_t insertion_index = 0; insertion_index < node_count; insertion_index++) {
+            tree_root_ptr = insert_node_pooled(tree_root_ptr, key_distribution(random_engine), node_pool);
+        }
+        start_time = std::chrono::steady_clock::now();
+        node_pool.release_all_nodes();
+        stop_time = std::chrono::steady_clock::now();
+        console_output << "  Pool bulk release (random):      "
+                       << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    }
+    
+    // Background teardown: only the hand-off is on the caller's path
+    tree_root_ptr = build_random_benchmark_tree(node_count, 27);
+    start_time = std::chrono::steady_clock::now();
+    std::future<void> teardown_future = deallocate_tree_memory_async(tree_root_ptr);
+    stop_time = std::chrono::steady_clock::now();
+    teardown_future.wait();
+    console_output << "  Async hand-off latency (random): "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+}
+
+// Compare one-at-a-time insertion against 64k-key insert_batch() on the same uniform stream
+void run_batch_insert_benchmark(size_t node_count) {
+    const size_t batch_size = 65536;
+    console_output << "Batch insert benchmark with " << node_count << " keys in batches of " << batch_size << "\n";
+    
+    std::mt19937 random_engine(29);
+    std::uniform_int_distribution<int> key_distribution(0, 2000000000);
+    std::vector<int> key_stream(node_count);
+    for (int& key_value : key_stream) {
+        key_value = key_distribution(random_engine);
+    }
+    
+    // Baseline: every key descends from the root
+    TreeNode* tree_root_ptr = nullptr;
+    auto start_time = std::chrono::steady_clock::now();
+    for (int key_value : key_stream) {
+        tree_root_ptr = insert_node_iterative(tree_root_ptr, key_value);
+    }
+    auto stop_time = std::chrono::steady_clock::now();
+    console_output << "  insert_node_iterative: "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms, "
+                   << count_total_nodes(tree_root_ptr) << " nodes\n";
+    deallocate_tree_memory(tree_root_ptr);
+    
+    // Batched: sort, dedup and merge each 64k chunk
+    tree_root_ptr = nullptr;
+    size_t tree_node_count = 0;
+    std::vector<int> batch_values;
+    start_time = std::chrono::steady_clock::now();
+    for (size_t batch_begin = 0; batch_begin < key_stream.size(); batch_begin += batch_size) {
+        size_t batch_end = std::min(batch_begin + batch_size, key_stream.size());
+        batch_values.assign(key_stream.begin() + batch_begin, key_stream.begin() + batch_end);
+        tree_node_count += insert_batch(tree_root_ptr, batch_values, tree_node_count);
+    }
+    stop_time = std::chrono::steady_clock::now();
+    console_output << "  insert_batch:          "
+                   << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms, "
+                   << tree_node_count << " nodes, height " << calculate_tree_height(tree_root_ptr) << "\n";
+    deallocate_tree_memory(tree_root_ptr);
+}
+
+// Time radix_sort_keys() against std::sort for signed 32-bit and 64-bit keys
+void run_radix_sort_benchmark(size_t key_count) {
+    console_output << "Radix sort benchmark with " << key_count << " keys, "
+                   << std::max(1u, std::thread::hardware_concurrency()) << " hardware threads\n";
+    std::mt19937_64 random_engine(30);
+    
+    // Signed 32-bit keys spanning the full range
+    std::vector<int32_t> narrow_keys(key_count);
+    for (int32_t& key_value : narrow_keys) {
+        key_value = static_cast<int32_t>(random_engine());
+    }
+    std::vector<int32_t> narrow_reference = narrow_keys;
+    auto start_time = std::chrono::steady_clock::now();
+    std::sort(narrow_reference.begin(), narrow_reference.end());
+    auto stop_time = std::chrono::steady_clock::now();
+    double comparison_ms = std::chrono::duration<double, std::milli>(stop_time - start_time).count();
+    start_time = std::chrono::steady_clock::now();
+    radix_sort_keys(narrow_keys);
+    stop_time = std::chrono::steady_clock::now();
+    double radix_ms = std::chrono::duration<double, std::milli>(stop_time - start_time).count();
+    console_output << "  int32: std::sort " << comparison_ms << " ms, radix " << radix_ms << " ms ("
+                   << comparison_ms / radix_ms << "x)" << (narrow_keys == narrow_reference ? "" : " MISMATCH") << "\n";
+    narrow_keys.clear();
+    narrow_keys.shrink_to_fit();
+    narrow_reference.clear();
+    narrow_reference.shrink_to_fit();
+    
+    // Signed 64-bit keys spanning the full range
+    std::vector<int64_t> wide_keys(key_count);
+    for (int64_t& key_value : wide_keys) {
+        key_value = static_cast<int64_t>(random_engine());
+    }
+    std::vector<int64_t> wide_reference = wide_keys;
+    start_time = std::chrono::steady_clock::now();
+    std::sort(wide_reference.begin(), wide_reference.end());
+    stop_time = std::chrono::steady_clock::now();
+    comparison_ms = std::chrono::duration<double, std::milli>(stop_time - start_time).count();
+    start_time = std::chrono::steady_clock::now();
+    radix_sort_keys(wide_keys);
+    stop_time = std::chrono::steady_clock::now();
+    radix_ms = std::chrono::duration<double, std::milli>(stop_time - start_time).count();
+    console_output << "  int64: std::sort " << comparison_ms << " ms, radix " << radix_ms << " ms ("
+                   << comparison_ms / radix_ms << "x)" << (wide_keys == wide_reference ? "" : " MISMATCH") << "\n";
+}
+
+// Print an element_count traversal to /dev/null with per-element iostream versus the buffered path
+void run_output_benchmark(size_t element_count) {
+    console_output << "Output benchmark with a " << element_count << "-element traversal\n";
+    console_output.flush();
+    
+    std::vector<int> traversal_results(element_count);
+    for (size_t element_index = 0; element_index < element_count; element_index++) {
+        traversal_results[element_index] = static_cast<int>(element_index * 7);
+    }
+    
+    // Before: one stream insertion per element and separator, terminated with std::endl
+    {
+        std::ofstream null_stream("/dev/null");
+        auto start_time = std::chrono::steady_clock::now();
+        null_stream << "In-Order Traversal: ";
+        for (size_t element_index = 0; element_index < traversal_results.size(); element_index++) {
+            null_stream << traversal_results[element_index];
+            if (element_index < traversal_results.size() - 1) {
+                null_stream << " -> ";
+            }
+        }
+        null_stream << std::endl;
+        auto stop_time = std::chrono::steady_clock::now();
+        console_output << "  iostream per element:  "
+                       << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    }
+    
+    // After: to_chars into a 64 KiB buffer, one write() per chunk
+    {
+        int null_descriptor = open("/dev/null", O_WRONLY);
+        FormattedOutputBuffer null_output(null_descriptor);
+        auto start_time = std::chrono::steady_clock::now();
+        null_output << "In-Order Traversal: ";
+        for (size_t element_index = 0; element_index < traversal_results.size(); element_index++) {
+            null_output << traversal_results[element_index];
+            if (element_index < traversal_results.size() - 1) {
+                null_output << " -> ";
+            }
+        }
+        null_output << '\n';
+        null_output.flush();
+        auto stop_time = std::chrono::steady_clock::now();
+        console_output << "  FormattedOutputBuffer: "
+                       << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+        close(null_descriptor);
+    }
+    console_output.flush();
+}
+
+// Print command-line usage for the demo / load generator
+void display_usage(const char* program_name) {
+    console_output << "Usage: " << program_name << " [options]\n"
+                   << "       " << program_name << " --benchmark <rebalance|teardown|batch|radix|output|finger|splay|cache|bloom|branchless|snapshot|setops|reshard|stats|quantiles|sketch|visitor|fused|threaded> [size ...]\n\n"
+                   << "Options:\n"
+                   << "  --keys N             number of keys to generate (default: 15 demo keys; not valid with demo)\n"
+                   << "  --distribution D     demo, sorted, reverse, uniform, zipfian, clustered\n"
+                   << "  --seed S             random seed for generated workloads (default 42)\n"
+                   << "  --phases LIST        comma-separated phases 2-6 or 'all' (Phase 1 always runs)\n"
+                   << "  --variant V          plain, balanced, batch, counting, pooled, finger, splay\n"
+                   << "  --threads T          worker threads for parallel stages, at most 1024 (default: hardware)\n"
+                   << "  --searches N         Phase 4 lookups for generated workloads (default 1000)\n"
+                   << "  --display-limit N    traversal elements printed per line (default 64)\n"
+                   << "  --progress MODE      auto, tty, lines, off\n"
+                   << "  --metrics FORMAT     json (JSON lines), csv or off (default off)\n"
+                   << "  --metrics-file PATH  metrics destination, '-' for stdout (default '-')\n"
+                   << "  --lookup-cache SETS  cache Phase 4 search results in SETS 2-way sets (default 0 = off)\n"
+                   << "  --bloom-filter BITS  reject absent keys with a BITS-per-key Bloom filter (default 0 = off)\n"
+                   << "  --statistics MODE    exact (scan the tree), incremental (maintained on insert)\n"
+                   << "                       or sketch (stream summary with a KLL quantile sketch; approximate\n"
+                   << "                       median/percentiles, and no tree is built unless Phases 2-4 run)\n"
+                   << "  --sketch-error E     sketch rank error bound (default 0.01)\n"
+                   << "  --analysis MODE      separate (per-phase walks) or fused (one walk for Phases 2, 3, 5)\n"
+                   << "  --schedule MODE      serial or concurrent (Phases 2-5 as a task graph on --threads)\n"
+                   << "  --percentiles LIST   Phase 5 percentiles, e.g. 50,90,99,99.9 (default none)\n"
+                   << "  --help               show this message\n";
+    console_output.flush();
+}
+
+// Parse an unsigned decimal argument, rejecting trailing garbage
+static bool parse_unsigned_argument(const char* argument_text, uint64_t& parsed_value) {
+    const char* argument_end = argument_text + std::strlen(argument_text);
+    std::from_chars_result parse_result = std::from_chars(argument_text, argument_end, parsed_value);
+    return parse_result.ec == std::errc() && parse_result.ptr == argument_end;
+}
+
+// Parse command-line options; reports the first problem on stderr and returns false
+bool parse_driver_options(int argc, char* argv[], DriverOptions& driver_options) {
+    bool distribution_given = false;
+    bool keys_given = false;
+    
+    for (int argument_index = 1; argument_index < argc; argument_index++) {
+        std::string option_name = argv[argument_index];
+        
+        if (option_name == "--help" || option_name == "-h") {
+            driver_options.show_help = true;
+            continue;
+        }
+        
+        // Every remaining option takes exactly one value
+        if (argument_index + 1 >= argc) {
+            std::cerr << "Missing value for " << option_name << "\n";
+            return false;
+        }
+        std::string option_value = argv[++argument_index];
+        uint64_t numeric_value = 0;
+        
+        if (option_name == "--keys" || option_name == "--seed" || option_name == "--threads" ||
+            option_name == "--searches" || option_name == "--display-limit" || option_name == "--lookup-cache" ||
+            option_name == "--bloom-filter") {
+            if (!parse_unsigned_argument(option_value.c_str(), numeric_value)) {
+                std::cerr << "Invalid number for " << option_name << ": " << option_value << "\n";
+                return false;
+            }
+        }
+        
+        if (option_name == "--keys") {
+            if (numeric_value > static_cast<uint64_t>(INT_MAX)) {
+                std::cerr << "--keys must not exceed " << INT_MAX << "\n";
+                return false;
+            }
+            driver_options.key_count = numeric_value;
+            keys_given = true;
+        } else if (option_name == "--seed") {
+            driver_options.random_seed = numeric_value;
+        } else if (option_name == "--threads") {
+            // Each worker is a real std::thread, so a huge count is a typo rather than a request
+            if (numeric_value > 1024) {
+                std::cerr << "--threads must not exceed 1024\n";
+                return false;
+            }
+            driver_options.thread_count = static_cast<unsigned>(numeric_value);
+        } else if (option_name == "--searches") {
+            driver_options.search_count = numeric_value;
+        } else if (option_name == "--display-limit") {
+            driver_options.display_limit = numeric_value;
+        } else if (option_name == "--lookup-cache") {
+            if (numeric_value > (uint64_t(1) << 30)) {
+                std::cerr << "--lookup-cache must not exceed " << (uint64_t(1) << 30) << " sets\n";
+                return false;
+            }
+            driver_options.lookup_cache_sets = numeric_value;
+        } else if (option_name == "--bloom-filter") {
+            if (numeric_value > 64) {
+                std::cerr << "--bloom-filter must not exceed 64 bits per key\n";
+                return false;
+            }
+            driver_options.bloom_bits_per_key = static_cast<unsigned>(numeric_value);
+        } else if (option_name == "--distribution") {
+            distribution_given = true;
+            if (option_value == "demo") {
+                driver_options.key_distribution = KeyDistribution::demo;
+            } else if (option_value == "sorted") {
+                driver_options.key_distribution = KeyDistribution::sorted;
+            } else if (option_value == "reverse") {
+                driver_options.key_distribution = KeyDistribution::reverse;
+            } else if (option_value == "uniform") {
+                driver_options.key_distribution = KeyDistribution::uniform;
+            } else if (option_value == "zipfian") {
+                driver_options.key_distribution = KeyDistribution::zipfian;
+            } else if (option_value == "clustered") {
+                driver_options.key_distribution = KeyDistribution::clustered;
+            } else {
+                std::cerr << "Unknown distribution: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--variant") {
+            if (option_value == "plain") {
+                driver_options.tree_variant = TreeVariant::plain;
+            } else if (option_value == "balanced") {
+                driver_options.tree_variant = TreeVariant::balanced;
+            } else if (option_value == "batch") {
+                driver_options.tree_variant = TreeVariant::batch;
+            } else if (option_value == "counting") {
+                driver_options.tree_variant = TreeVariant::counting;
+            } else if (option_value == "pooled") {
+                driver_options.tree_variant = TreeVariant::pooled;
+            } else if (option_value == "finger") {
+                driver_options.tree_variant = TreeVariant::finger;
+            } else if (option_value == "splay") {
+                driver_options.tree_variant = TreeVariant::splay;
+            } else {
+                std::cerr << "Unknown variant: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--progress") {
+            if (option_value == "auto") {
+                driver_options.progress_mode = ProgressOutputMode::automatic;
+            } else if (option_value == "tty") {
+                driver_options.progress_mode = ProgressOutputMode::terminal;
+            } else if (option_value == "lines") {
+                driver_options.progress_mode = ProgressOutputMode::machine_lines;
+            } else if (option_value == "off") {
+                driver_options.progress_mode = ProgressOutputMode::silent;
+            } else {
+                std::cerr << "Unknown progress mode: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--metrics") {
+            if (option_value == "json") {
+                driver_options.metrics_format = MetricsFormat::json_lines;
+            } else if (option_value == "csv") {
+                driver_options.metrics_format = MetricsFormat::csv;
+            } else if (option_value == "off") {
+                driver_options.metrics_format = MetricsFormat::disabled;
+            } else {
+                std::cerr << "Unknown metrics format: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--statistics") {
+            if (option_value == "exact") {
+                driver_options.statistics_mode = StatisticsMode::exact;
+            } else if (option_value == "incremental") {
+                driver_options.statistics_mode = StatisticsMode::incremental;
+            } else if (option_value == "sketch") {
+                driver_options.statistics_mode = StatisticsMode::sketch;
+            } else {
+                std::cerr << "Unknown statistics mode: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--analysis") {
+            if (option_value == "separate") {
+                driver_options.analysis_mode = AnalysisMode::separate;
+            } else if (option_value == "fused") {
+                driver_options.analysis_mode = AnalysisMode::fused;
+            } else {
+                std::cerr << "Unknown analysis mode: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--schedule") {
+            if (option_value == "serial") {
+                driver_options.phase_schedule = PhaseSchedule::serial;
+            } else if (option_value == "concurrent") {
+                driver_options.phase_schedule = PhaseSchedule::concurrent;
+            } else {
+                std::cerr << "Unknown schedule: " << option_value << "\n";
+                return false;
+            }
+        } else if (option_name == "--sketch-error") {
+            char* parse_end = nullptr;
+            double rank_error = std::strtod(option_value.c_str(), &parse_end);
+            if (option_value.empty() || *parse_end != '\0' || !(rank_error > 0.0 && rank_error <= 0.5)) {
+                std::cerr << "Invalid --sketch-error: " << option_value << " (expected 0 < E <= 0.5)\n";
+                return false;
+            }
+            driver_options.sketch_rank_error = rank_error;
+        } else if (option_name == "--percentiles") {
+            driver_options.reported_percentiles.clear();
+            size_t token_begin = 0;
+            while (token_begin <= option_value.size()) {
+                size_t token_end = option_value.find(',', token_begin);
+                if (token_end == std::string::npos) {
+                    token_end = option_value.size();
+                }
+                std::string percentile_token = option_value.substr(token_begin, token_end - token_begin);
+                char* parse_end = nullptr;
+                double percentile = std::strtod(percentile_token.c_str(), &parse_end);
+                if (percentile_token.empty() || *parse_end != '\0' || !(percentile > 0.0 && percentile <= 100.0)) {
+                    std::cerr << "Invalid percentile in --percentiles: '" << percentile_token << "' (expected 0-100)\n";
+                    return false;
+                }
+                driver_options.reported_percentiles.push_back(percentile);
+                token_begin = token_end + 1;
+            }
+        } else if (option_name == "--metrics-file") {
+            driver_options.metrics_path = option_value;
+        } else if (option_name == "--phases") {
+            driver_options.enabled_phase_mask = 0;
+            if (option_value == "all") {
+                driver_options.enabled_phase_mask = 0x7E;
+                continue;
+            }
+            size_t token_begin = 0;
+            while (token_begin <= option_value.size()) {
+                size_t token_end = option_value.find(',', token_begin);
+                if (token_end == std::string::npos) {
+                    token_end = option_value.size();
+                }
+                std::string phase_token = option_value.substr(token_begin, token_end - token_begin);
+                if (!parse_unsigned_argument(phase_token.c_str(), numeric_value) || numeric_value < 2 || numeric_value > 6) {
+                    std::cerr << "Invalid phase in --phases: '" << phase_token << "' (expected 2-6; Phase 1 always runs)\n";
+                    return false;
+                }
+                driver_options.enabled_phase_mask |= 1u << numeric_value;
+                token_begin = token_end + 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << option_name << "\n";
+            return false;
+        }
+    }
+    
+    // The demo workload is a fixed set of 15 keys, so a key count cannot apply to it
+    if (distribution_given && keys_given && driver_options.key_distribution == KeyDistribution::demo) {
+        std::cerr << "--keys cannot be combined with --distribution demo (its 15 keys are fixed)\n";
+        return false;
+    }
+    
+    // Asking for a key count without a distribution means a uniform workload
+    if (!distribution_given && keys_given) {
+        driver_options.key_distribution = KeyDistribution::uniform;
+    }
+    return true;
+}
+
+// Phase 1 always runs; phases 2-6 follow --phases
+bool phase_is_enabled(const DriverOptions& driver_options, int phase_number) {
+    return phase_number == 1 || (driver_options.enabled_phase_mask & (1u << phase_number)) != 0;
+}
+
+// SplitMix64 finalizer: spreads ranks and counters over the key space
+uint64_t scramble_key_bits(uint64_t key_bits) {
+    key_bits += 0x9E3779B97F4A7C15ULL;
+    key_bits = (key_bits ^ (key_bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key_bits = (key_bits ^ (key_bits >> 27)) * 0x94D049BB133111EBULL;
+    return key_bits ^ (key_bits >> 31);
+}
+
+// Zipfian set-up computes the generalized harmonic numbers once
+ZipfianKeyGenerator::ZipfianKeyGenerator(uint64_t item_count, double skew_exponent)
+    : item_total(std::max<uint64_t>(item_count, 1)), theta_exponent(skew_exponent), zeta_total(0.0) {
+    for (uint64_t rank_index = 1; rank_index <= item_total; rank_index++) {
+        zeta_total += 1.0 / std::pow(static_cast<double>(rank_index), theta_exponent);
+    }
+    double zeta_two = 1.0 + 1.0 / std::pow(2.0, theta_exponent);
+    alpha_factor = 1.0 / (1.0 - theta_exponent);
+    eta_factor = (1.0 - std::pow(2.0 / item_total, 1.0 - theta_exponent)) / (1.0 - zeta_two / zeta_total);
+}
+
+// Draw a rank in [0, item_total); rank 0 is the most popular
+uint64_t ZipfianKeyGenerator::next_rank(std::mt19937_64& random_engine) {
+    double uniform_sample = std::uniform_real_distribution<double>(0.0, 1.0)(random_engine);
+    double scaled_sample = uniform_sample * zeta_total;
+    
+    if (scaled_sample < 1.0) {
+        return 0;
+    }
+    if (scaled_sample < 1.0 + std::pow(0.5, theta_exponent)) {
+        return std::min<uint64_t>(1, item_total - 1);
+    }
+    uint64_t drawn_rank = static_cast<uint64_t>(item_total * std::pow(eta_factor * uniform_sample - eta_factor + 1.0, alpha_factor));
+    return std::min(drawn_rank, item_total - 1);
+}
+
+// Demo keys, inserted in this order so the tree has the textbook shape
+static const int demo_workload_keys[] = {50, 30, 70, 20, 40, 60, 80, 10, 25, 35, 45, 55, 65, 75, 85};
+
+// Set up per-distribution generator state; only the clustered centres take memory proportional to the key count
+WorkloadKeyStream::WorkloadKeyStream(const DriverOptions& driver_options)
+    : key_distribution(driver_options.key_distribution), key_total(driver_options.key_count),
+      random_engine(driver_options.random_seed) {
+    if (key_distribution == KeyDistribution::demo) {
+        key_total = sizeof(demo_workload_keys) / sizeof(demo_workload_keys[0]);
+    } else if (key_distribution == KeyDistribution::zipfian) {
+        rank_generator.reset(new ZipfianKeyGenerator(key_total));
+    } else if (key_distribution == KeyDistribution::clustered) {
+        // Roughly 1024 keys per cluster, normally spread around each centre
+        size_t cluster_count = std::max<size_t>(1, key_total / 1024);
+        cluster_centres.resize(cluster_count);
+        std::uniform_int_distribution<int> centre_distribution(INT_MIN / 2, INT_MAX / 2);
+        for (int& centre_value : cluster_centres) {
+            centre_value = centre_distribution(random_engine);
+        }
+        cluster_choice = std::uniform_int_distribution<size_t>(0, cluster_count - 1);
+    }
+}
+
+bool WorkloadKeyStream::next_key(int& key_value) {
+    if (next_index == key_total) {
+        return false;
+    }
+    size_t key_index = next_index++;
+    switch (key_distribution) {
+        case KeyDistribution::demo:
+            key_value = demo_workload_keys[key_index];
+            break;
+        case KeyDistribution::sorted:
+            key_value = static_cast<int>(key_index);
+            break;
+        case KeyDistribution::reverse:
+            key_value = static_cast<int>(key_total - 1 - key_index);
+            break;
+        case KeyDistribution::uniform:
+            key_value = uniform_distribution(random_engine);
+            break;
+        case KeyDistribution::zipfian:
+            // Popular ranks repeat; scrambling keeps hot keys spread across the tree
+            key_value = static_cast<int>(static_cast<uint32_t>(scramble_key_bits(rank_generator->next_rank(random_engine))));
+            break;
+        case KeyDistribution::clustered:
+            key_value = cluster_centres[cluster_choice(random_engine)] + static_cast<int>(offset_distribution(random_engine));
+            break;
+    }
+    return true;
+}
+
+// Generate the Phase 1 keys for the selected distribution and seed
+std::vector<int> generate_workload_keys(const DriverOptions& driver_options) {
+    WorkloadKeyStream key_stream(driver_options);
+    std::vector<int> workload_keys;
+    workload_keys.reserve(key_stream.size());
+    int key_value;
+    while (key_stream.next_key(key_value)) {
+        workload_keys.push_back(key_value);
+    }
+    return workload_keys;
+}
+
+// Phase 4 targets: fixed demo probes, or an even mix of present keys and random probes
+std::vector<int> generate_search_targets(const DriverOptions& driver_options, const std::vector<int>& input_dataset) {
+    if (driver_options.key_distribution == KeyDistribution::demo) {
+        return {25, 75, 100, 1, 50};
+    }
+    
+    std::vector<int> search_targets;
+    search_targets.reserve(driver_options.search_count);
+    std::mt19937_64 random_engine(driver_options.random_seed ^ 0x5EA5C4ULL);
+    std::uniform_int_distribution<int> probe_distribution(INT_MIN, INT_MAX);
+    
+    for (size_t search_index = 0; search_index < driver_options.search_count; search_index++) {
+        if (search_index % 2 == 0 && !input_dataset.empty()) {
+            search_targets.push_back(input_dataset[random_engine() % input_dataset.size()]);
+        } else {
+            search_targets.push_back(probe_distribution(random_engine));
+        }
+    }
+    return search_targets;
+}
+
+// Insert one workload key with the selected variant; returns 1 when the key was new
+size_t insert_workload_key(DriverTreeState& tree_state, int insertion_value) {
+    if (tree_state.lookup_cache.is_enabled()) {
+        tree_state.lookup_cache.invalidate_key(insertion_value);
+    }
+    if (tree_state.key_filter.is_enabled()) {
+        tree_state.key_filter.insert_key(insertion_value);
+    }
+    if (tree_state.running_statistics.is_enabled()) {
+        tree_state.running_statistics.record_insert(insertion_value);
+    }
+    switch (tree_state.tree_variant) {
+        case TreeVariant::counting:
+            return insert_node_counting(tree_state.root_ptr, insertion_value) ? 1 : 0;
+        case TreeVariant::pooled: {
+            size_t pooled_before = tree_state.node_pool.allocated_node_count();
+            tree_state.root_ptr = insert_node_pooled(tree_state.root_ptr, insertion_value, tree_state.node_pool);
+            return tree_state.node_pool.allocated_node_count() - pooled_before;
+        }
+        case TreeVariant::finger:
+            return finger_insert(tree_state.root_ptr, tree_state.access_finger, insertion_value) ? 1 : 0;
+        case TreeVariant::splay:
+            return splay_insert(tree_state.root_ptr, insertion_value) ? 1 : 0;
+        default:
+            return insert_node_unique(tree_state.root_ptr, insertion_value) ? 1 : 0;
+    }
+}
+
+// Remove one workload key with the selected variant, dropping its cached search result; returns 1 when it was present.
+// The Bloom filter is left alone since it cannot remove keys: the deleted key keeps passing it, so later misses
+// count as false positives
+size_t delete_workload_key(DriverTreeState& tree_state, int target_value) {
+    if (tree_state.lookup_cache.is_enabled()) {
+        tree_state.lookup_cache.invalidate_key(target_value);
+    }
+    if (tree_state.running_statistics.is_enabled()) {
+        tree_state.running_statistics.record_delete(target_value);
+    }
+    switch (tree_state.tree_variant) {
+        case TreeVariant::pooled:
+            // Pool nodes are only released together, so the detached node stays in its block until teardown
+            return unlink_node_value(tree_state.root_ptr, target_value) != nullptr ? 1 : 0;
+        case TreeVariant::finger:
+            tree_state.access_finger.reset();   // The remembered path may run through the removed node
+            return delete_node_value(tree_state.root_ptr, target_value) ? 1 : 0;
+        default:
+            return delete_node_value(tree_state.root_ptr, target_value) ? 1 : 0;
+    }
+}
+
+// Look up one key with the selected variant, bypassing the lookup cache
+static bool search_tree_variant(DriverTreeState& tree_state, int target_value) {
+    if (tree_state.tree_variant == TreeVariant::finger) {
+        return finger_search(tree_state.root_ptr, tree_state.access_finger, target_value);
+    }
+    if (tree_state.tree_variant == TreeVariant::splay) {
+        return splay_search(tree_state.root_ptr, target_value);
+    }
+    return search_node_value(tree_state.root_ptr, target_value);
+}
+
+// Look up one key: the Bloom filter rejects most absent keys, then the lookup cache, then the tree
+bool search_workload_key(DriverTreeState& tree_state, int target_value) {
+    bool filter_enabled = tree_state.key_filter.is_enabled();
+    if (filter_enabled && !tree_state.key_filter.may_contain(target_value)) {
+        tree_state.filter_rejections++;
+        return false;
+    }
+    
+    bool search_result;
+    if (tree_state.lookup_cache.is_enabled()) {
+        search_result = tree_state.lookup_cache.lookup(target_value, [&tree_state](int key_value) {
+            return search_tree_variant(tree_state, key_value);
+        });
+    } else {
+        search_result = search_tree_variant(tree_state, target_value);
+    }
+    if (filter_enabled && !search_result) {
+        tree_state.filter_false_positives++;
+    }
+    return search_result;
+}
+
+// Elapsed wall-clock time since the timer was created
+double PhaseTimer::wall_milliseconds() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+}
+
+// Process CPU time (all threads) since the timer was created
+double PhaseTimer::cpu_milliseconds() const {
+    return 1000.0 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+}
+
+// Report a phase's wall-clock and CPU time
+void display_phase_timing(const PhaseTimer& phase_timer, FormattedOutputBuffer& output) {
+    output << "Phase Time: " << FixedPrecision(phase_timer.wall_milliseconds(), 3) << " ms wall, ";
+    if (phase_timer.owns_process_resources()) {
+        output << FixedPrecision(phase_timer.cpu_milliseconds(), 3) << " ms CPU\n";
+    } else {
+        output << "CPU not attributed (concurrent phases)\n";
+    }
+}
+
+// Printable names for the workload options
+const char* key_distribution_name(KeyDistribution key_distribution) {
+    switch (key_distribution) {
+        case KeyDistribution::demo: return "demo";
+        case KeyDistribution::sorted: return "sorted";
+        case KeyDistribution::reverse: return "reverse";
+        case KeyDistribution::uniform: return "uniform";
+        case KeyDistribution::zipfian: return "zipfian";
+        case KeyDistribution::clustered: return "clustered";
+    }
+    return "unknown";
+}
+
+const char* tree_variant_name(TreeVariant tree_variant) {
+    switch (tree_variant) {
+        case TreeVariant::plain: return "plain";
+        case TreeVariant::balanced: return "balanced";
+        case TreeVariant::batch: return "batch";
+        case TreeVariant::counting: return "counting";
+        case TreeVariant::pooled: return "pooled";
+        case TreeVariant::finger: return "finger";
+        case TreeVariant::splay: return "splay";
+    }
+    return "unknown";
+}
+
+// Open the metrics destination; CSV output starts with a header row
+bool MetricsRecorder::configure(MetricsFormat output_format, const std::string& output_path) {
+    metrics_format = output_format;
+    if (metrics_format == MetricsFormat::disabled) {
+        return true;
+    }
+    
+    int output_descriptor = 1;
+    if (output_path != "-") {
+        output_descriptor = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (output_descriptor < 0) {
+            metrics_format = MetricsFormat::disabled;
+            return false;
+        }
+        metrics_descriptor = output_descriptor;
+    }
+    shares_console_output = output_descriptor == 1;
+    metrics_output.reset(new FormattedOutputBuffer(output_descriptor));
+    
+    if (metrics_format == MetricsFormat::csv) {
+        *metrics_output << "phase,metric,value\n";
+    }
+    return true;
+}
+
+// Capture records for a phase running off the main thread; the driver commits them in phase order
+void MetricsRecorder::configure_capture(MetricsFormat output_format) {
+    metrics_format = output_format;
+    if (metrics_format != MetricsFormat::disabled) {
+        metrics_output.reset(new FormattedOutputBuffer(-1));
+    }
+}
+
+void MetricsRecorder::commit_captured_records(MetricsRecorder& destination_recorder) {
+    if (!is_enabled() || !destination_recorder.is_enabled()) {
+        return;
+    }
+    metrics_output->drain_into(*destination_recorder.metrics_output);
+    destination_recorder.flush_records();
+}
+
+// Write buffered records; on stdout the console text already rendered for the phase goes out first
+void MetricsRecorder::flush_records() {
+    if (shares_console_output) {
+        console_output.flush();
+    }
+    metrics_output->flush();
+}
+
+// Flush pending output and close a metrics file we opened
+MetricsRecorder::~MetricsRecorder() {
+    metrics_output.reset();
+    if (metrics_descriptor >= 0) {
+        close(metrics_descriptor);
+    }
+}
+
+// Start collecting metrics for a phase
+void MetricsRecorder::begin_phase(const char* phase_name) {
+    if (!is_enabled()) {
+        return;
+    }
+    current_phase = phase_name;
+    pending_record.clear();
+}
+
+void MetricsRecorder::record_integer(const char* metric_name, long long metric_value) {
+    if (!is_enabled()) {
+        return;
+    }
+    char format_storage[24];
+    append_field(metric_name, std::string(format_storage, std::to_chars(format_storage, format_storage + sizeof(format_storage), metric_value).ptr), false);
+}
+
+void MetricsRecorder::record_decimal(const char* metric_name, double metric_value) {
+    if (!is_enabled()) {
+        return;
+    }
+    // JSON has no NaN/infinity literals
+    if (!std::isfinite(metric_value)) {
+        append_field(metric_name, "null", false);
+        return;
+    }
+    char format_storage[64];
+    append_field(metric_name, std::string(format_storage, std::to_chars(format_storage, format_storage + sizeof(format_storage),
+                                                                        metric_value, std::chars_format::general, 12).ptr), false);
+}
+
+void MetricsRecorder::record_text(const char* metric_name, const std::string& metric_value) {
+    if (!is_enabled()) {
+        return;
+    }
+    append_field(metric_name, metric_value, true);
+}
+
+// Render one field in the selected format (names and text values are plain identifiers)
+void MetricsRecorder::append_field(const char* metric_name, const std::string& rendered_value, bool quoted) {
+    if (metrics_format == MetricsFormat::json_lines) {
+        pending_record += ",\"";
+        pending_record += metric_name;
+        pending_record += quoted ? "\":\"" : "\":";
+        pending_record += rendered_value;
+        if (quoted) {
+            pending_record += '"';
+        }
+    } else {
+        pending_record += current_phase;
+        pending_record += ',';
+        pending_record += metric_name;
+        pending_record += ',';
+        pending_record += rendered_value;
+        pending_record += '\n';
+    }
+}
+
+// Attach timings and peak RSS, then emit the phase record
+void MetricsRecorder::end_phase(const PhaseTimer& phase_timer) {
+    if (!is_enabled()) {
+        return;
+    }
+    record_decimal("wall_ms", phase_timer.wall_milliseconds());
+    if (phase_timer.owns_process_resources()) {
+        record_decimal("cpu_ms", phase_timer.cpu_milliseconds());
+    }
+    record_integer("peak_rss_kib", read_process_memory_kib("VmHWM"));
+    record_integer("rss_kib", read_resident_memory_kib());
+    record_integer("live_nodes", static_cast<long long>(allocation_ledger.live_nodes.load(std::memory_order_relaxed)));
+    record_integer("node_bytes", static_cast<long long>(allocation_ledger.node_bytes.load(std::memory_order_relaxed)));
+    
+    // Per-phase deltas are only meaningful when no other phase ran in between
+    if (phase_timer.owns_process_resources()) {
+        record_integer("phase_peak_node_bytes", static_cast<long long>(allocation_ledger.phase_peak_node_bytes.load(std::memory_order_relaxed)));
+        record_integer("node_allocation_calls", static_cast<long long>(
+            allocation_ledger.node_allocation_calls.load(std::memory_order_relaxed) - phase_timer.node_allocation_calls_start));
+        record_integer("node_release_calls", static_cast<long long>(
+            allocation_ledger.node_release_calls.load(std::memory_order_relaxed) - phase_timer.node_release_calls_start));
+    }
+    record_integer("buffer_bytes", static_cast<long long>(allocation_ledger.buffer_bytes.load(std::memory_order_relaxed)));
+    record_integer("peak_buffer_bytes", static_cast<long long>(allocation_ledger.peak_buffer_bytes.load(std::memory_order_relaxed)));
+    
+    if (metrics_format == MetricsFormat::json_lines) {
+        *metrics_output << "{\"phase\":\"" << current_phase << '"' << pending_record << "}\n";
+    } else {
+        *metrics_output << pending_record;
+    }
+    flush_records();
+    pending_record.clear();
+}
+
+// Near-sequential keys (increasing with small jitter): root descent versus finger operations
+void run_finger_benchmark(size_t key_count) {
+    console_output << "Finger benchmark with " << key_count << " near-sequential keys (jitter +/-8)\n";
+    std::mt19937_64 random_engine(36);
+    std::uniform_int_distribution<int> jitter_distribution(-8, 8);
+    std::vector<int> key_stream(key_count);
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        key_stream[key_index] = static_cast<int>(key_index * 4) + jitter_distribution(random_engine);
+    }
+    
+    // Insertion: every root descent walks the whole right spine
+    TreeNode* tree_root_ptr = nullptr;
+    auto start_time = std::chrono::steady_clock::now();
+    for (int key_value : key_stream) {
+        insert_node_unique(tree_root_ptr, key_value);
+    }
+    auto stop_time = std::chrono::steady_clock::now();
+    console_output << "  insert_node_unique: " << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    deallocate_tree_memory(tree_root_ptr);
+    
+    tree_root_ptr = nullptr;
+    TreeFinger access_finger;
+    start_time = std::chrono::steady_clock::now();
+    for (int key_value : key_stream) {
+        finger_insert(tree_root_ptr, access_finger, key_value);
+    }
+    stop_time = std::chrono::steady_clock::now();
+    console_output << "  finger_insert:      " << std::chrono::duration<double, std::milli>(stop_time - start_time).count() << " ms\n";
+    
+    // Lookups in the same order on a balanced copy of the tree
+    tree_root_ptr = rebalance_tree_in_place(tree_root_ptr);
+    access_finger.reset();
+    size_t found_count = 0;
+    start_time = std::chrono::steady_clock::now();
+    for (int key_value : key_stream) {
+        found_count += search_node_value(tree_root_ptr, key_value);
+    }
+    stop_time = std::chrono::steady_clock::now();
+    console_output << "  search_node_value (balanced): " << std::chrono::duration<double, std::milli>(stop_time - start_time).count()
+                   << " ms, " << found_count << " found\n";
+    
+    found_count = 0;
+    start_time = std::chrono::steady_clock::now();
+    for (int key_value : key_stream) {
+        found_count += finger_search(tree_root_ptr, access_finger, key_value);
+    }
+    stop_time = std::chrono::steady_clock::now();
+    console_output << "  finger_search (balanced):     " << std::chrono::duration<double, std::milli>(stop_time - start_time).count()
+                   << " ms, " << found_count << " found\n";
+    deallocate_tree_memory(tree_root_ptr);
+    console_output.flush();
+}
+
+// Time one query stream against a tree; splay mode restructures the tree as it goes
+static double time_query_stream(TreeNode*& root_ptr, const std::vector<int>& query_stream, bool use_splay, size_t& found_count) {
+    found_count = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    for (int query_value : query_stream) {
+        found_count += use_splay ? splay_search(root_ptr, query_value) : search_node_value(root_ptr, query_value);
+    }
+    auto stop_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop_time - start_time).count() / std::max<size_t>(1, query_stream.size());
+}
+
+// Plain BST, DSW-balanced BST and splay tree on uniform versus zipfian query streams
+void run_splay_benchmark(size_t key_count) {
+    console_output << "Splay benchmark with " << key_count << " uniform keys and " << key_count << " queries per stream\n";
+    console_output.flush();
+    std::mt19937_64 random_engine(37);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    std::vector<int> tree_keys(key_count);
+    for (int& key_value : tree_keys) {
+        key_value = key_distribution(random_engine);
+    }
+    
+    // Query streams over the stored keys: uniform picks and zipfian (hot ranks)
+    std::vector<int> uniform_queries(key_count);
+    std::vector<int> zipfian_queries(key_count);
+    ZipfianKeyGenerator rank_generator(key_count);
+    for (size_t query_index = 0; query_index < key_count; query_index++) {
+        uniform_queries[query_index] = tree_keys[random_engine() % key_count];
+        zipfian_queries[query_index] = tree_keys[rank_generator.next_rank(random_engine)];
+    }
+    
+    TreeNode* plain_root_ptr = nullptr;
+    TreeNode* balanced_root_ptr = nullptr;
+    TreeNode* splay_root_ptr = nullptr;
+    for (int key_value : tree_keys) {
+        insert_node_unique(plain_root_ptr, key_value);
+        insert_node_unique(balanced_root_ptr, key_value);
+        splay_insert(splay_root_ptr, key_value);
+    }
+    balanced_root_ptr = rebalance_tree_in_place(balanced_root_ptr);
+    
+    const char* tree_labels[] = {"plain BST", "balanced (DSW)", "splay"};
+    TreeNode** tree_roots[] = {&plain_root_ptr, &balanced_root_ptr, &splay_root_ptr};
+    for (int tree_index = 0; tree_index < 3; tree_index++) {
+        size_t uniform_found = 0;
+        size_t zipfian_found = 0;
+        double uniform_ns = time_query_stream(*tree_roots[tree_index], uniform_queries, tree_index == 2, uniform_found);
+        double zipfian_ns = time_query_stream(*tree_roots[tree_index], zipfian_queries, tree_index == 2, zipfian_found);
+        console_output << "  " << tree_labels[tree_index] << ": uniform " << FixedPrecision(uniform_ns, 1)
+                       << " ns/query, zipfian " << FixedPrecision(zipfian_ns, 1) << " ns/query ("
+                       << uniform_found + zipfian_found << " found)\n";
+    }
+    
+    deallocate_tree_memory(plain_root_ptr);
+    deallocate_tree_memory(balanced_root_ptr);
+    deallocate_tree_memory(splay_root_ptr);
+    console_output.flush();
+}
+
+// Allocate (or drop, for 0) the cache; sets are rounded up to a power of two, at least one line
+void HotKeyLookupCache::configure(size_t requested_sets) {
+    cache_lines.reset();
+    set_mask = 0;
+    if (requested_sets == 0) {
+        return;
+    }
+    size_t rounded_sets = 4;
+    while (rounded_sets < requested_sets) {
+        rounded_sets <<= 1;
+    }
+    cache_lines.reset(new CacheLine[rounded_sets / 4]);
+    set_mask = rounded_sets - 1;
+    clear();
+}
+
+// Cache set for a key; the hash spreads clustered keys across sets
+HotKeyLookupCache::CacheSet& HotKeyLookupCache::locate_set(int key_value) {
+    size_t set_index = scramble_key_bits(static_cast<uint32_t>(key_value)) & set_mask;
+    return cache_lines[set_index >> 2].cache_sets[set_index & 3];
+}
+
+// Answer from the cache when possible, otherwise ask the tree and remember the result in the LRU way
+template <typename TreeLookup>
+bool HotKeyLookupCache::lookup(int target_value, TreeLookup&& tree_lookup) {
+    bool sample_latency = (lookup_counter++ & 63) == 0;
+    std::chrono::steady_clock::time_point sample_start;
+    if (sample_latency) {
+        sample_start = std::chrono::steady_clock::now();
+    }
+    
+    CacheSet& cache_set = locate_set(target_value);
+    bool cache_hit = false;
+    bool search_result = false;
+    for (int way_index = 0; way_index < 2; way_index++) {
+        if (cache_set.way_state[way_index] != 0 && cache_set.cached_keys[way_index] == target_value) {
+            cache_hit = true;
+            search_result = cache_set.way_state[way_index] == 2;
+            cache_set.replacement_way = static_cast<uint8_t>(way_index ^ 1);
+            break;
+        }
+    }
+    if (!cache_hit) {
+        search_result = tree_lookup(target_value);
+        int victim_way = cache_set.replacement_way;
+        cache_set.cached_keys[victim_way] = target_value;
+        cache_set.way_state[victim_way] = search_result ? 2 : 1;
+        cache_set.replacement_way = static_cast<uint8_t>(victim_way ^ 1);
+    }
+    
+    if (cache_hit) {
+        cache_hits++;
+    } else {
+        cache_misses++;
+    }
+    if (sample_latency) {
+        double elapsed_nanoseconds =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - sample_start).count();
+        if (cache_hit) {
+            sampled_hits++;
+            sampled_hit_nanoseconds += elapsed_nanoseconds;
+        } else {
+            sampled_misses++;
+            sampled_miss_nanoseconds += elapsed_nanoseconds;
+        }
+    }
+    return search_result;
+}
+
+// Drop any cached result for a key whose membership is about to change
+void HotKeyLookupCache::invalidate_key(int key_value) {
+    CacheSet& cache_set = locate_set(key_value);
+    for (int way_index = 0; way_index < 2; way_index++) {
+        if (cache_set.cached_keys[way_index] == key_value) {
+            cache_set.way_state[way_index] = 0;
+        }
+    }
+}
+
+// Empty every set and reset the counters
+void HotKeyLookupCache::clear() {
+    if (cache_lines != nullptr) {
+        std::memset(static_cast<void*>(cache_lines.get()), 0, (set_mask + 1) / 4 * sizeof(CacheLine));
+    }
+    lookup_counter = 0;
+    cache_hits = 0;
+    cache_misses = 0;
+    sampled_hits = 0;
+    sampled_misses = 0;
+    sampled_hit_nanoseconds = 0.0;
+    sampled_miss_nanoseconds = 0.0;
+}
+
+// Mean latency of sampled cache hits
+double HotKeyLookupCache::mean_hit_nanoseconds() const {
+    return sampled_hits == 0 ? 0.0 : sampled_hit_nanoseconds / sampled_hits;
+}
+
+// Mean latency of sampled cache misses (includes the tree search)
+double HotKeyLookupCache::mean_miss_nanoseconds() const {
+    return sampled_misses == 0 ? 0.0 : sampled_miss_nanoseconds / sampled_misses;
+}
+
+// Zipfian query stream over present and absent keys with interleaved inserts and deletes, per cache size
+void run_lookup_cache_benchmark(size_t key_count) {
+    console_output << "Lookup cache benchmark with " << key_count << " keys, " << 2 * key_count
+                   << " zipfian queries (half absent keys), one insert and delete per 1000 queries\n";
+    console_output.flush();
+    std::mt19937_64 random_engine(38);
+    std::vector<int> tree_keys(key_count);
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        tree_keys[key_index] = static_cast<int>(2 * key_index);   // Even keys are stored, odd keys are absent
+    }
+    std::shuffle(tree_keys.begin(), tree_keys.end(), random_engine);
+    
+    // Hot ranks map to scattered even (present) and odd (absent) keys
+    size_t query_count = 2 * key_count;
+    std::vector<int> query_stream(query_count);
+    ZipfianKeyGenerator rank_generator(query_count);
+    for (int& query_value : query_stream) {
+        uint64_t query_rank = rank_generator.next_rank(random_engine);
+        query_value = static_cast<int>(scramble_key_bits(query_rank) % query_count);
+    }
+    
+    const size_t cache_set_counts[] = {0, 256, 4096, 65536};
+    for (size_t cache_sets : cache_set_counts) {
+        DriverTreeState tree_state;
+        tree_state.lookup_cache.configure(cache_sets);
+        for (int key_value : tree_keys) {
+            insert_workload_key(tree_state, key_value);
+        }
+        
+        // Mutations flip hot keys so stale cache entries would change the found count
+        std::mt19937_64 mutation_engine(381);
+        size_t found_count = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        for (size_t query_index = 0; query_index < query_count; query_index++) {
+            found_count += search_workload_key(tree_state, query_stream[query_index]);
+            if (query_index % 1000 == 999) {
+                int mutated_value = query_stream[mutation_engine() % query_count];
+                if (delete_workload_key(tree_state, mutated_value) == 0) {
+                    insert_workload_key(tree_state, mutated_value);
+                }
+            }
+        }
+        auto stop_time = std::chrono::steady_clock::now();
+        double nanoseconds_per_query =
+            query_count == 0 ? 0.0 : std::chrono::duration<double, std::nano>(stop_time - start_time).count() / query_count;
+        
+        const HotKeyLookupCache& lookup_cache = tree_state.lookup_cache;
+        if (!lookup_cache.is_enabled()) {
+            console_output << "  uncached: " << FixedPrecision(nanoseconds_per_query, 1) << " ns/query ("
+                           << found_count << " found)\n";
+        } else {
+            uint64_t cache_lookups = lookup_cache.hit_count() + lookup_cache.miss_count();
+            double hit_rate = cache_lookups == 0 ? 0.0 : 100.0 * lookup_cache.hit_count() / cache_lookups;
+            console_output << "  " << lookup_cache.set_count() << " sets: " << FixedPrecision(nanoseconds_per_query, 1)
+                           << " ns/query, hit rate " << FixedPrecision(hit_rate, 2) << "%, sampled "
+                           << FixedPrecision(lookup_cache.mean_hit_nanoseconds(), 1) << " ns hit / "
+                           << FixedPrecision(lookup_cache.mean_miss_nanoseconds(), 1) << " ns miss ("
+                           << found_count << " found)\n";
+        }
+        deallocate_tree_memory(tree_state.root_ptr);
+    }
+    console_output.flush();
+}
+
+// Size the filter for expected_keys; deleted keys stay set, so rebuild after heavy deletion
+void BlockedBloomFilter::configure(size_t expected_keys, unsigned bits_per_key) {
+    filter_blocks.clear();
+    if (bits_per_key == 0) {
+        return;
+    }
+    size_t total_bits = std::max<size_t>(expected_keys, 1) * bits_per_key;
+    size_t block_total = (total_bits + 511) / 512;
+    filter_blocks.assign(block_total, FilterBlock{});
+}
+
+// One bit per word chosen by multiply-shift with a distinct odd salt; the loop vectorizes
+void BlockedBloomFilter::compute_block_mask(uint32_t key_hash, uint64_t (&block_mask)[8]) {
+    static const uint32_t word_salts[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                           0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    for (int word_index = 0; word_index < 8; word_index++) {
+        uint32_t bit_index = (key_hash * word_salts[word_index]) >> 26;
+        block_mask[word_index] = uint64_t(1) << bit_index;
+    }
+}
+
+// High hash bits pick the block (multiply-shift range reduction, no division)
+size_t BlockedBloomFilter::locate_block(uint64_t key_hash) const {
+    return static_cast<size_t>(((key_hash >> 32) * filter_blocks.size()) >> 32);
+}
+
+// Set the key's eight bits in its block
+void BlockedBloomFilter::insert_key(int key_value) {
+    uint64_t key_hash = scramble_key_bits(static_cast<uint32_t>(key_value));
+    uint64_t block_mask[8];
+    compute_block_mask(static_cast<uint32_t>(key_hash), block_mask);
+    FilterBlock& filter_block = filter_blocks[locate_block(key_hash)];
+    for (int word_index = 0; word_index < 8; word_index++) {
+        filter_block.filter_words[word_index] |= block_mask[word_index];
+    }
+}
+
+// A key is possibly present only when all eight bits are set; the probe reads one cache line
+bool BlockedBloomFilter::may_contain(int key_value) const {
+    uint64_t key_hash = scramble_key_bits(static_cast<uint32_t>(key_value));
+    uint64_t block_mask[8];
+    compute_block_mask(static_cast<uint32_t>(key_hash), block_mask);
+    const FilterBlock& filter_block = filter_blocks[locate_block(key_hash)];
+    uint64_t missing_bits = 0;
+    for (int word_index = 0; word_index < 8; word_index++) {
+        missing_bits |= block_mask[word_index] & ~filter_block.filter_words[word_index];
+    }
+    return missing_bits == 0;
+}
+
+// 80% absent / 20% present lookups with and without the filter at several sizes
+void run_bloom_filter_benchmark(size_t key_count) {
+    console_output << "Bloom filter benchmark with " << key_count << " keys and " << key_count
+                   << " lookups (80% absent)\n";
+    console_output.flush();
+    
+    // Even keys are stored and odd keys are absent, so every miss is a real near-miss
+    std::mt19937_64 random_engine(39);
+    std::vector<int> tree_keys(key_count);
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        tree_keys[key_index] = static_cast<int>(2 * key_index);
+    }
+    std::shuffle(tree_keys.begin(), tree_keys.end(), random_engine);
+    std::vector<int> miss_queries;
+    std::vector<int> mixed_queries(key_count);
+    for (int& query_value : mixed_queries) {
+        int stored_value = tree_keys[random_engine() % key_count];
+        query_value = random_engine() % 5 == 0 ? stored_value : stored_value + 1;
+        if (query_value != stored_value) {
+            miss_queries.push_back(query_value);
+        }
+    }
+    
+    const unsigned bits_per_key_options[] = {0, 8, 12, 16};
+    for (unsigned bits_per_key : bits_per_key_options) {
+        DriverTreeState tree_state;
+        tree_state.key_filter.configure(key_count, bits_per_key);
+        for (int key_value : tree_keys) {
+            insert_workload_key(tree_state, key_value);
+        }
+        
+        auto mixed_start = std::chrono::steady_clock::now();
+        size_t found_count = 0;
+        for (int query_value : mixed_queries) {
+            found_count += search_workload_key(tree_state, query_value);
+        }
+        auto miss_start = std::chrono::steady_clock::now();
+        size_t miss_found_count = 0;
+        for (int query_value : miss_queries) {
+            miss_found_count += search_workload_key(tree_state, query_value);
+        }
+        auto miss_stop = std::chrono::steady_clock::now();
+        double mixed_ns = std::chrono::duration<double, std::nano>(miss_start - mixed_start).count() /
+                          std::max<size_t>(1, mixed_queries.size());
+        double miss_ns = std::chrono::duration<double, std::nano>(miss_stop - miss_start).count() /
+                         std::max<size_t>(1, miss_queries.size());
+        
+        if (bits_per_key == 0) {
+            console_output << "  no filter: ";
+        } else {
+            console_output << "  " << bits_per_key << " bits/key (" << tree_state.key_filter.memory_bytes() / 1024 << " KiB): ";
+        }
+        console_output << FixedPrecision(mixed_ns, 1) << " ns/lookup, " << FixedPrecision(miss_ns, 1) << " ns/miss";
+        if (bits_per_key != 0) {
+            // Both streams ran through the filter; every counted false positive is an absent key
+            uint64_t absent_lookups = tree_state.filter_rejections + tree_state.filter_false_positives;
+            double false_positive_rate = absent_lookups == 0 ? 0.0 : 100.0 * tree_state.filter_false_positives / absent_lookups;
+            console_output << ", false positives " << FixedPrecision(false_positive_rate, 3) << '%';
+        }
+        console_output << " (" << found_count << " found, " << miss_found_count << " misses found)\n";
+        deallocate_tree_memory(tree_state.root_ptr);
+    }
+    console_output.flush();
+}
+
+// Slot 0 stands in for the null child so descents never test for a null pointer
+IndexedTreePool::IndexedTreePool() {
+    tree_nodes.push_back(IndexedTreeNode{0, {0, 0}});
+}
+
+// Iterative insert following child_index[value > key]; returns false for duplicates
+bool IndexedTreePool::insert_key(int insertion_value) {
+    uint32_t new_index = static_cast<uint32_t>(tree_nodes.size());
+    if (root_index == 0) {
+        tree_nodes.push_back(IndexedTreeNode{insertion_value, {0, 0}});
+        root_index = new_index;
+        return true;
+    }
+    uint32_t current_index = root_index;
+    for (;;) {
+        IndexedTreeNode& current_node = tree_nodes[current_index];
+        if (current_node.data_payload == insertion_value) {
+            return false;
+        }
+        int child_slot = insertion_value > current_node.data_payload;
+        if (current_node.child_index[child_slot] == 0) {
+            current_node.child_index[child_slot] = new_index;
+            break;
+        }
+        current_index = current_node.child_index[child_slot];
+    }
+    tree_nodes.push_back(IndexedTreeNode{insertion_value, {0, 0}});
+    return true;
+}
+
+// Same candidate-tracking descent as search_node_value_branchless(), with the child picked by array index
+bool IndexedTreePool::search_key(int target_value) const {
+    const IndexedTreeNode* node_array = tree_nodes.data();
+    uint32_t candidate_index = 0;
+    uint32_t current_index = root_index;
+    while (current_index != 0) {
+        const IndexedTreeNode& current_node = node_array[current_index];
+        bool descend_right = current_node.data_payload < target_value;
+        candidate_index = descend_right ? candidate_index : current_index;
+        current_index = current_node.child_index[descend_right];
+    }
+    return candidate_index != 0 && node_array[candidate_index].data_payload == target_value;
+}
+
+// Hardware branch-miss counter for the calling thread; reports unavailable where perf_event_open is not allowed
+class BranchMissCounter {
+public:
+    BranchMissCounter() {
+#ifdef __linux__
+        perf_event_attr event_attributes;
+        std::memset(&event_attributes, 0, sizeof(event_attributes));
+        event_attributes.type = PERF_TYPE_HARDWARE;
+        event_attributes.size = sizeof(event_attributes);
+        event_attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+        event_attributes.disabled = 1;
+        event_attributes.exclude_kernel = 1;
+        event_attributes.exclude_hv = 1;
+        counter_descriptor = static_cast<int>(syscall(SYS_perf_event_open, &event_attributes, 0, -1, -1, 0));
+#endif
+    }
+    ~BranchMissCounter() {
+        if (counter_descriptor >= 0) {
+            close(counter_descriptor);
+        }
+    }
+    BranchMissCounter(const BranchMissCounter&) = delete;
+    BranchMissCounter& operator=(const BranchMissCounter&) = delete;
+    
+    bool is_available() const { return counter_descriptor >= 0; }
+    void start() {
+#ifdef __linux__
+        if (counter_descriptor >= 0) {
+            ioctl(counter_descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    uint64_t stop() {
+        uint64_t miss_count = 0;
+#ifdef __linux__
+        if (counter_descriptor >= 0) {
+            ioctl(counter_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(counter_descriptor, &miss_count, sizeof(miss_count)) != sizeof(miss_count)) {
+                miss_count = 0;
+            }
+        }
+#endif
+        return miss_count;
+    }
+    
+private:
+    int counter_descriptor = -1;
+};
+
+// The original recursive lookup with a data-dependent branch per level, kept as the benchmark baseline
+static bool search_node_value_recursive(TreeNode* current_node, int target_value) {
+    if (current_node == nullptr) {
+        return false;
+    }
+    if (current_node->data_payload == target_value) {
+        return true;
+    }
+    if (target_value < current_node->data_payload) {
+        return search_node_value_recursive(current_node->left_child_ptr, target_value);
+    }
+    return search_node_value_recursive(current_node->right_child_ptr, target_value);
+}
+
+// Random hit/miss lookups: recursive baseline, iterative, branchless pointer tree and branchless index tree
+void run_branchless_search_benchmark(size_t key_count) {
+    console_output << "Branchless search benchmark with " << key_count << " random keys and " << key_count
+                   << " lookups (50% hits)\n";
+    console_output.flush();
+    std::mt19937_64 random_engine(40);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN / 2, INT_MAX / 2);
+    std::vector<int> tree_keys(key_count);
+    TreeNode* root_ptr = nullptr;
+    IndexedTreePool indexed_tree;
+    for (int& key_value : tree_keys) {
+        key_value = key_distribution(random_engine) * 2;   // Even keys stored, odd probes always miss
+        insert_node_unique(root_ptr, key_value);
+        indexed_tree.insert_key(key_value);
+    }
+    std::vector<int> query_stream(key_count);
+    for (int& query_value : query_stream) {
+        query_value = tree_keys[random_engine() % key_count] + static_cast<int>(random_engine() & 1);
+    }
+    
+    BranchMissCounter branch_miss_counter;
+    if (!branch_miss_counter.is_available()) {
+        console_output << "  (branch-miss counters unavailable: perf_event_open not permitted; timing only)\n";
+    }
+    const char* search_labels[] = {"recursive (before)", "iterative", "branchless pointer", "branchless indexed"};
+    for (int search_index = 0; search_index < 4; search_index++) {
+        size_t found_count = 0;
+        branch_miss_counter.start();
+        auto start_time = std::chrono::steady_clock::now();
+        for (int query_value : query_stream) {
+            if (search_index == 0) {
+                found_count += search_node_value_recursive(root_ptr, query_value);
+            } else if (search_index == 1) {
+                found_count += search_node_value(root_ptr, query_value);
+            } else if (search_index == 2) {
+                found_count += search_node_value_branchless(root_ptr, query_value);
+            } else {
+                found_count += indexed_tree.search_key(query_value);
+            }
+        }
+        auto stop_time = std::chrono::steady_clock::now();
+        uint64_t branch_misses = branch_miss_counter.stop();
+        
+        double nanoseconds_per_lookup = std::chrono::duration<double, std::nano>(stop_time - start_time).count() / key_count;
+        console_output << "  " << search_labels[search_index] << ": " << FixedPrecision(nanoseconds_per_lookup, 1)
+                       << " ns/lookup";
+        if (branch_miss_counter.is_available()) {
+            console_output << ", " << FixedPrecision(static_cast<double>(branch_misses) / key_count, 2)
+                           << " branch misses/lookup";
+        }
+        console_output << " (" << found_count << " found)\n";
+    }
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
+}
+
+// Persistent nodes are counted in the allocation ledger like heap TreeNodes
+PersistentTreeNode::PersistentTreeNode(int value, NodeHandle left_subtree, NodeHandle right_subtree)
+    : data_payload(value), left_child(std::move(left_subtree)), right_child(std::move(right_subtree)) {
+    allocation_ledger.record_node_allocation(1, sizeof(PersistentTreeNode), 1);
+}
+
+// Children this node owns exclusively are detached onto an explicit stack instead of being destroyed recursively
+PersistentTreeNode::~PersistentTreeNode() {
+    allocation_ledger.record_node_release(1, sizeof(PersistentTreeNode), 1);
+    bool owns_left_chain = left_child != nullptr && left_child.use_count() == 1;
+    bool owns_right_chain = right_child != nullptr && right_child.use_count() == 1;
+    if (!owns_left_chain && !owns_right_chain) {
+        return;   // Shared children only lose a reference
+    }
+    
+    std::vector<NodeHandle> release_stack;
+    release_stack.push_back(std::move(left_child));
+    release_stack.push_back(std::move(right_child));
+    while (!release_stack.empty()) {
+        NodeHandle released_node = std::move(release_stack.back());
+        release_stack.pop_back();
+        if (released_node != nullptr && released_node.use_count() == 1) {
+            // Sole owner: no snapshot can observe this node any more, so its links may be taken
+            PersistentTreeNode& owned_node = const_cast<PersistentTreeNode&>(*released_node);
+            if (owned_node.left_child != nullptr) {
+                release_stack.push_back(std::move(owned_node.left_child));
+            }
+            if (owned_node.right_child != nullptr) {
+                release_stack.push_back(std::move(owned_node.right_child));
+            }
+        }
+    }
+}
+
+// Start from an empty published version
+PersistentTreeStore::PersistentTreeStore() : current_version(std::make_shared<const PersistentTreeVersion>()) {}
+
+// Pin the current version without copying. std::atomic_load on a shared_ptr briefly takes one of the library's
+// internal mutexes, so taking a snapshot can wait on a concurrent publish; walking the pinned version never locks
+PersistentTreeStore::Snapshot PersistentTreeStore::take_snapshot() const {
+    return std::atomic_load(&current_version);
+}
+
+// Copy the root-to-leaf path with the new key attached, then publish the new root with one atomic store
+bool PersistentTreeStore::insert_key(int insertion_value) {
+    std::lock_guard<std::mutex> writer_lock(writer_mutex);
+    Snapshot base_version = std::atomic_load(&current_version);
+    
+    // Record the insertion path; every node off the path is shared with the new version
+    std::vector<const PersistentTreeNode*> access_path;
+    const PersistentTreeNode* current_node = base_version->root_node.get();
+    while (current_node != nullptr) {
+        if (current_node->data_payload == insertion_value) {
+            return false;
+        }
+        access_path.push_back(current_node);
+        current_node = insertion_value < current_node->data_payload ? current_node->left_child.get()
+                                                                    : current_node->right_child.get();
+    }
+    
+    // Rebuild the path bottom-up around the new leaf
+    PersistentTreeNode::NodeHandle rebuilt_subtree = std::make_shared<PersistentTreeNode>(insertion_value, nullptr, nullptr);
+    for (size_t path_index = access_path.size(); path_index-- > 0;) {
+        const PersistentTreeNode* original_node = access_path[path_index];
+        if (insertion_value < original_node->data_payload) {
+            rebuilt_subtree = std::make_shared<PersistentTreeNode>(original_node->data_payload, std::move(rebuilt_subtree),
+                                                                   original_node->right_child);
+        } else {
+            rebuilt_subtree = std::make_shared<PersistentTreeNode>(original_node->data_payload, original_node->left_child,
+                                                                   std::move(rebuilt_subtree));
+        }
+    }
+    
+    auto next_version = std::make_shared<PersistentTreeVersion>();
+    next_version->root_node = std::move(rebuilt_subtree);
+    next_version->node_count = base_version->node_count + 1;
+    next_version->version_number = base_version->version_number + 1;
+    std::atomic_store(&current_version, Snapshot(std::move(next_version)));
+    return true;
+}
+
+// Lookup within one snapshot (the caller's snapshot keeps every node alive)
+bool persistent_search(const PersistentTreeNode* current_node, int target_value) {
+    while (current_node != nullptr && current_node->data_payload != target_value) {
+        current_node = target_value < current_node->data_payload ? current_node->left_child.get()
+                                                                 : current_node->right_child.get();
+    }
+    return current_node != nullptr;
+}
+
+// In-order keys of one snapshot using an explicit stack
+void collect_persistent_inorder(const PersistentTreeNode* root_node, std::vector<int>& traversal_results) {
+    std::vector<const PersistentTreeNode*> pending_nodes;
+    const PersistentTreeNode* current_node = root_node;
+    while (current_node != nullptr || !pending_nodes.empty()) {
+        while (current_node != nullptr) {
+            pending_nodes.push_back(current_node);
+            current_node = current_node->left_child.get();
+        }
+        current_node = pending_nodes.back();
+        pending_nodes.pop_back();
+        traversal_results.push_back(current_node->data_payload);
+        current_node = current_node->right_child.get();
+    }
+}
+
+// Snapshot readers (lookups plus periodic full consistency walks) while a writer keeps inserting
+void run_snapshot_benchmark(size_t key_count) {
+    unsigned reader_count = std::max(1u, resolve_worker_thread_count(0) - 1);
+    console_output << "Snapshot benchmark: " << key_count << " preloaded keys, " << key_count
+                   << " concurrent inserts, " << reader_count << " reader thread(s)\n";
+    console_output.flush();
+    
+    std::mt19937_64 random_engine(41);
+    std::vector<int> key_stream(2 * key_count);
+    for (size_t key_index = 0; key_index < key_stream.size(); key_index++) {
+        key_stream[key_index] = static_cast<int>(key_index);
+    }
+    std::shuffle(key_stream.begin(), key_stream.end(), random_engine);
+    uint64_t live_nodes_before = allocation_ledger.live_nodes.load(std::memory_order_relaxed);
+    
+    for (int reader_mode = 0; reader_mode < 2; reader_mode++) {
+        PersistentTreeStore tree_store;
+        for (size_t key_index = 0; key_index < key_count; key_index++) {
+            tree_store.insert_key(key_stream[key_index]);
+        }
+        
+        // Readers pin a snapshot, probe it, and every 64th snapshot check the full in-order sequence
+        std::atomic<bool> writer_finished{false};
+        std::atomic<uint64_t> snapshots_taken{0};
+        std::atomic<uint64_t> reader_lookups{0};
+        std::atomic<uint64_t> consistency_failures{0};
+        std::vector<std::thread> reader_threads;
+        auto run_reader = [&](unsigned reader_index) {
+            std::mt19937_64 reader_engine(4100 + reader_index);
+            std::vector<int> traversal_buffer;
+            uint64_t local_snapshots = 0;
+            uint64_t local_lookups = 0;
+            while (!writer_finished.load(std::memory_order_acquire)) {
+                PersistentTreeStore::Snapshot tree_snapshot = tree_store.take_snapshot();
+                local_snapshots++;
+                for (int probe_index = 0; probe_index < 256; probe_index++) {
+                    int probe_value = key_stream[reader_engine() % key_count];   // Preloaded, so always present
+                    if (!persistent_search(tree_snapshot->root_node.get(), probe_value)) {
+                        consistency_failures.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                local_lookups += 256;
+                if (local_snapshots % 64 == 0) {
+                    traversal_buffer.clear();
+                    collect_persistent_inorder(tree_snapshot->root_node.get(), traversal_buffer);
+                    if (traversal_buffer.size() != tree_snapshot->node_count ||
+                        !std::is_sorted(traversal_buffer.begin(), traversal_buffer.end())) {
+                        consistency_failures.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+            snapshots_taken.fetch_add(local_snapshots, std::memory_order_relaxed);
+            reader_lookups.fetch_add(local_lookups, std::memory_order_relaxed);
+        };
+        
+        auto start_time = std::chrono::steady_clock::now();
+        if (reader_mode == 1) {
+            for (unsigned reader_index = 0; reader_index < reader_count; reader_index++) {
+                reader_threads.emplace_back(run_reader, reader_index);
+            }
+        }
+        for (size_t key_index = key_count; key_index < key_stream.size(); key_index++) {
+            tree_store.insert_key(key_stream[key_index]);
+        }
+        auto stop_time = std::chrono::steady_clock::now();
+        writer_finished.store(true, std::memory_order_release);
+        for (std::thread& reader_thread : reader_threads) {
+            reader_thread.join();
+        }
+        
+        double elapsed_seconds = std::chrono::duration<double>(stop_time - start_time).count();
+        if (reader_mode == 0) {
+            console_output << "  writer alone: " << FixedPrecision(key_count / elapsed_seconds / 1e6, 3) << " M inserts/s\n";
+        } else {
+            console_output << "  with readers: " << FixedPrecision(key_count / elapsed_seconds / 1e6, 3) << " M inserts/s, "
+                           << FixedPrecision(snapshots_taken.load() / elapsed_seconds, 0) << " snapshots/s, "
+                           << FixedPrecision(reader_lookups.load() / elapsed_seconds / 1e6, 3) << " M lookups/s, "
+                           << consistency_failures.load() << " consistency failures\n";
+        }
+        console_output << "  final version: " << tree_store.take_snapshot()->version_number << " ("
+                       << tree_store.take_snapshot()->node_count << " keys)\n";
+    }
+    
+    // Every version has been released with its store and snapshots
+    uint64_t live_nodes_after = allocation_ledger.live_nodes.load(std::memory_order_relaxed);
+    console_output << "  persistent nodes still live after release: " << (live_nodes_after - live_nodes_before) << '\n';
+    console_output.flush();
+}
+
+// Treap priority derived from the key itself, so nodes need no extra field and equal key sets share one shape
+static uint64_t treap_priority(const TreeNode* node_ptr) {
+    return scramble_key_bits(static_cast<uint32_t>(node_ptr->data_payload));
+}
+
+// Split by key into (< key), the node equal to key (detached, or null) and (> key); one walk down, nodes reused
+void split_treap(TreeNode* root_ptr, int split_key, TreeNode*& less_root_ptr, TreeNode*& equal_node_ptr,
+                 TreeNode*& greater_root_ptr) {
+    TreeNode** less_link_ptr = &less_root_ptr;
+    TreeNode** greater_link_ptr = &greater_root_ptr;
+    equal_node_ptr = nullptr;
+    TreeNode* current_node_ptr = root_ptr;
+    while (current_node_ptr != nullptr) {
+        if (current_node_ptr->data_payload < split_key) {
+            *less_link_ptr = current_node_ptr;
+            less_link_ptr = &current_node_ptr->right_child_ptr;
+            current_node_ptr = current_node_ptr->right_child_ptr;
+        } else if (current_node_ptr->data_payload > split_key) {
+            *greater_link_ptr = current_node_ptr;
+            greater_link_ptr = &current_node_ptr->left_child_ptr;
+            current_node_ptr = current_node_ptr->left_child_ptr;
+        } else {
+            equal_node_ptr = current_node_ptr;
+            *less_link_ptr = current_node_ptr->left_child_ptr;
+            *greater_link_ptr = current_node_ptr->right_child_ptr;
+            current_node_ptr->left_child_ptr = nullptr;
+            current_node_ptr->right_child_ptr = nullptr;
+            return;
+        }
+    }
+    *less_link_ptr = nullptr;
+    *greater_link_ptr = nullptr;
+}
+
+// Join two treaps where every key on the left is smaller than every key on the right (merge of the spines)
+TreeNode* join_treaps(TreeNode* left_root_ptr, TreeNode* right_root_ptr) {
+    TreeNode* joined_root_ptr = nullptr;
+    TreeNode** attach_link_ptr = &joined_root_ptr;
+    while (left_root_ptr != nullptr && right_root_ptr != nullptr) {
+        if (treap_priority(left_root_ptr) > treap_priority(right_root_ptr)) {
+            *attach_link_ptr = left_root_ptr;
+            attach_link_ptr = &left_root_ptr->right_child_ptr;
+            left_root_ptr = left_root_ptr->right_child_ptr;
+        } else {
+            *attach_link_ptr = right_root_ptr;
+            attach_link_ptr = &right_root_ptr->left_child_ptr;
+            right_root_ptr = right_root_ptr->left_child_ptr;
+        }
+    }
+    *attach_link_ptr = left_root_ptr != nullptr ? left_root_ptr : right_root_ptr;
+    return joined_root_ptr;
+}
+
+// Treap insert: descend while ancestors outrank the new key, then split that subtree beneath the new node
+bool treap_insert(TreeNode*& root_ptr, int insertion_value) {
+    if (search_node_value(root_ptr, insertion_value)) {
+        return false;
+    }
+    TreeNode* new_node_ptr = new TreeNode(insertion_value);
+    uint64_t new_priority = treap_priority(new_node_ptr);
+    TreeNode** attach_link_ptr = &root_ptr;
+    while (*attach_link_ptr != nullptr && treap_priority(*attach_link_ptr) > new_priority) {
+        attach_link_ptr = insertion_value < (*attach_link_ptr)->data_payload ? &(*attach_link_ptr)->left_child_ptr
+                                                                              : &(*attach_link_ptr)->right_child_ptr;
+    }
+    TreeNode* unused_equal_ptr = nullptr;
+    split_treap(*attach_link_ptr, insertion_value, new_node_ptr->left_child_ptr, unused_equal_ptr,
+                new_node_ptr->right_child_ptr);
+    *attach_link_ptr = new_node_ptr;
+    return true;
+}
+
+// Reshape any BST (e.g. built by insert_node_iterative) into the treap on the same nodes in O(n)
+TreeNode* convert_to_treap(TreeNode* root_ptr) {
+    // In-order node list, then a Cartesian-tree build with a right-spine stack
+    std::vector<TreeNode*> sorted_nodes;
+    std::vector<TreeNode*> pending_nodes;
+    TreeNode* current_node_ptr = root_ptr;
+    while (current_node_ptr != nullptr || !pending_nodes.empty()) {
+        while (current_node_ptr != nullptr) {
+            pending_nodes.push_back(current_node_ptr);
+            current_node_ptr = current_node_ptr->left_child_ptr;
+        }
+        current_node_ptr = pending_nodes.back();
+        pending_nodes.pop_back();
+        sorted_nodes.push_back(current_node_ptr);
+        current_node_ptr = current_node_ptr->right_child_ptr;
+    }
+    
+    std::vector<TreeNode*>& right_spine = pending_nodes;
+    for (TreeNode* node_ptr : sorted_nodes) {
+        TreeNode* last_popped_ptr = nullptr;
+        while (!right_spine.empty() && treap_priority(right_spine.back()) < treap_priority(node_ptr)) {
+            last_popped_ptr = right_spine.back();
+            right_spine.pop_back();
+        }
+        node_ptr->left_child_ptr = last_popped_ptr;
+        node_ptr->right_child_ptr = nullptr;
+        if (!right_spine.empty()) {
+            right_spine.back()->right_child_ptr = node_ptr;
+        }
+        right_spine.push_back(node_ptr);
+    }
+    return right_spine.empty() ? nullptr : right_spine.front();
+}
+
+// Recursion depth below which the two halves of a set operation run as separate tasks
+static int set_operation_fork_depth(unsigned thread_count) {
+    unsigned worker_threads = resolve_worker_thread_count(thread_count);
+    int fork_depth = 0;
+    while ((1u << fork_depth) < worker_threads) {
+        fork_depth++;
+    }
+    return worker_threads > 1 ? fork_depth + 1 : 0;   // One extra level of tasks for load balance
+}
+
+// Run the left recursion as a task while this thread handles the right one (serial once fork_depth is spent)
+template <typename SetOperation>
+static void run_set_operation_halves(SetOperation set_operation, int fork_depth,
+                                     TreeNode* first_left_ptr, TreeNode* second_left_ptr, TreeNode*& left_result_ptr,
+                                     TreeNode* first_right_ptr, TreeNode* second_right_ptr, TreeNode*& right_result_ptr) {
+    if (fork_depth > 0) {
+        std::future<TreeNode*> left_future =
+            std::async(std::launch::async, set_operation, first_left_ptr, second_left_ptr, fork_depth - 1);
+        right_result_ptr = set_operation(first_right_ptr, second_right_ptr, fork_depth - 1);
+        left_result_ptr = left_future.get();
+    } else {
+        left_result_ptr = set_operation(first_left_ptr, second_left_ptr, 0);
+        right_result_ptr = set_operation(first_right_ptr, second_right_ptr, 0);
+    }
+}
+
+// Union: the higher-priority root stays on top and splits the other treap around its key
+static TreeNode* treap_union(TreeNode* first_root_ptr, TreeNode* second_root_ptr, int fork_depth) {
+    if (first_root_ptr == nullptr) {
+        return second_root_ptr;
+    }
+    if (second_root_ptr == nullptr) {
+        return first_root_ptr;
+    }
+    if (treap_priority(first_root_ptr) < treap_priority(second_root_ptr)) {
+        std::swap(first_root_ptr, second_root_ptr);
+    }
+    TreeNode* second_less_ptr = nullptr;
+    TreeNode* duplicate_node_ptr = nullptr;
+    TreeNode* second_greater_ptr = nullptr;
+    split_treap(second_root_ptr, first_root_ptr->data_payload, second_less_ptr, duplicate_node_ptr, second_greater_ptr);
+    delete duplicate_node_ptr;
+    run_set_operation_halves(treap_union, fork_depth,
+                             first_root_ptr->left_child_ptr, second_less_ptr, first_root_ptr->left_child_ptr,
+                             first_root_ptr->right_child_ptr, second_greater_ptr, first_root_ptr->right_child_ptr);
+    return first_root_ptr;
+}
+
+// Intersection: keep the top root only when the other treap also holds its key, otherwise join the halves;
+// subtrees facing an empty side are freed, which costs O(dropped nodes) on top of the split/join work
+static TreeNode* treap_intersection(TreeNode* first_root_ptr, TreeNode* second_root_ptr, int fork_depth) {
+    if (first_root_ptr == nullptr || second_root_ptr == nullptr) {
+        deallocate_tree_memory(first_root_ptr);
+        deallocate_tree_memory(second_root_ptr);
+        return nullptr;
+    }
+    if (treap_priority(first_root_ptr) < treap_priority(second_root_ptr)) {
+        std::swap(first_root_ptr, second_root_ptr);
+    }
+    TreeNode* second_less_ptr = nullptr;
+    TreeNode* matching_node_ptr = nullptr;
+    TreeNode* second_greater_ptr = nullptr;
+    split_treap(second_root_ptr, first_root_ptr->data_payload, second_less_ptr, matching_node_ptr, second_greater_ptr);
+    TreeNode* left_result_ptr = nullptr;
+    TreeNode* right_result_ptr = nullptr;
+    run_set_operation_halves(treap_intersection, fork_depth,
+                             first_root_ptr->left_child_ptr, second_less_ptr, left_result_ptr,
+                             first_root_ptr->right_child_ptr, second_greater_ptr, right_result_ptr);
+    if (matching_node_ptr != nullptr) {
+        delete matching_node_ptr;
+        first_root_ptr->left_child_ptr = left_result_ptr;
+        first_root_ptr->right_child_ptr = right_result_ptr;
+        return first_root_ptr;
+    }
+    delete first_root_ptr;
+    return join_treaps(left_result_ptr, right_result_ptr);
+}
+
+// Difference (first minus second): split the first treap around the second's root and drop that key
+static TreeNode* treap_difference(TreeNode* first_root_ptr, TreeNode* second_root_ptr, int fork_depth) {
+    if (first_root_ptr == nullptr || second_root_ptr == nullptr) {
+        deallocate_tree_memory(second_root_ptr);
+        return first_root_ptr;
+    }
+    TreeNode* first_less_ptr = nullptr;
+    TreeNode* removed_node_ptr = nullptr;
+    TreeNode* first_greater_ptr = nullptr;
+    split_treap(first_root_ptr, second_root_ptr->data_payload, first_less_ptr, removed_node_ptr, first_greater_ptr);
+    delete removed_node_ptr;
+    TreeNode* second_left_ptr = second_root_ptr->left_child_ptr;
+    TreeNode* second_right_ptr = second_root_ptr->right_child_ptr;
+    delete second_root_ptr;
+    TreeNode* left_result_ptr = nullptr;
+    TreeNode* right_result_ptr = nullptr;
+    run_set_operation_halves(treap_difference, fork_depth,
+                             first_less_ptr, second_left_ptr, left_result_ptr,
+                             first_greater_ptr, second_right_ptr, right_result_ptr);
+    return join_treaps(left_result_ptr, right_result_ptr);
+}
+
+// Set operations consume both treaps: result nodes are reused, every other node is freed
+TreeNode* tree_union(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count) {
+    return treap_union(first_root_ptr, second_root_ptr, set_operation_fork_depth(thread_count));
+}
+
+TreeNode* tree_intersection(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count) {
+    return treap_intersection(first_root_ptr, second_root_ptr, set_operation_fork_depth(thread_count));
+}
+
+TreeNode* tree_difference(TreeNode* first_root_ptr, TreeNode* second_root_ptr, unsigned thread_count) {
+    return treap_difference(first_root_ptr, second_root_ptr, set_operation_fork_depth(thread_count));
+}
+
+// Plain BST built by insert_node_iterative() from keys in the given order, as callers build their trees today
+static TreeNode* build_tree_from_keys(const std::vector<int>& key_values) {
+    TreeNode* root_ptr = nullptr;
+    for (int key_value : key_values) {
+        root_ptr = insert_node_iterative(root_ptr, key_value);
+    }
+    return root_ptr;
+}
+
+// Keys strictly increase in order and no child outranks its parent: the shape convert_to_treap() promises
+static bool treap_invariants_hold(TreeNode* root_ptr) {
+    bool keys_ordered = true;
+    bool previous_seen = false;
+    int previous_key = 0;
+    visit_inorder(root_ptr, [&](int key_value) {
+        keys_ordered = !previous_seen || previous_key < key_value;
+        previous_seen = true;
+        previous_key = key_value;
+        return keys_ordered;
+    });
+    if (!keys_ordered) {
+        return false;
+    }
+    
+    std::vector<TreeNode*> pending_nodes;
+    if (root_ptr != nullptr) {
+        pending_nodes.push_back(root_ptr);
+    }
+    while (!pending_nodes.empty()) {
+        TreeNode* node_ptr = pending_nodes.back();
+        pending_nodes.pop_back();
+        for (TreeNode* child_ptr : {node_ptr->left_child_ptr, node_ptr->right_child_ptr}) {
+            if (child_ptr != nullptr) {
+                if (treap_priority(child_ptr) > treap_priority(node_ptr)) {
+                    return false;
+                }
+                pending_nodes.push_back(child_ptr);
+            }
+        }
+    }
+    return true;
+}
+
+// Join-based union/intersection/difference versus per-key search and insert on insert_node_iterative() trees,
+// balanced and 1000:1 sizes
+void run_set_operation_benchmark(size_t key_count) {
+    unsigned worker_threads = resolve_worker_thread_count(0);
+    console_output << "Set operation benchmark with " << key_count << " keys, " << worker_threads << " thread(s)\n";
+    std::mt19937_64 random_engine(42);
+    std::uniform_int_distribution<int> key_distribution(0, static_cast<int>(std::min<size_t>(4 * key_count, INT_MAX)));
+    const char* operation_names[] = {"union", "intersection", "difference"};
+    
+    const size_t size_ratios[] = {1, 1000};
+    for (size_t size_ratio : size_ratios) {
+        std::vector<int> first_keys(key_count);
+        std::vector<int> second_keys(std::max<size_t>(1, key_count / size_ratio));
+        for (int& key_value : first_keys) {
+            key_value = key_distribution(random_engine);
+        }
+        for (int& key_value : second_keys) {
+            key_value = key_distribution(random_engine);
+        }
+        std::vector<int> first_sorted = first_keys;
+        std::vector<int> second_sorted = second_keys;
+        for (std::vector<int>* sorted_keys : {&first_sorted, &second_sorted}) {
+            std::sort(sorted_keys->begin(), sorted_keys->end());
+            sorted_keys->erase(std::unique(sorted_keys->begin(), sorted_keys->end()), sorted_keys->end());
+        }
+        console_output << "  sizes " << first_sorted.size() << " and " << second_sorted.size() << ":\n";
+        
+        for (int operation_index = 0; operation_index < 3; operation_index++) {
+            std::vector<int> expected_keys;
+            if (operation_index == 0) {
+                std::set_union(first_sorted.begin(), first_sorted.end(), second_sorted.begin(), second_sorted.end(),
+                               std::back_inserter(expected_keys));
+            } else if (operation_index == 1) {
+                std::set_intersection(first_sorted.begin(), first_sorted.end(), second_sorted.begin(), second_sorted.end(),
+                                      std::back_inserter(expected_keys));
+            } else {
+                std::set_difference(first_sorted.begin(), first_sorted.end(), second_sorted.begin(), second_sorted.end(),
+                                    std::back_inserter(expected_keys));
+            }
+            
+            // Per-key baseline on a plain BST: search/insert/delete each second-set key in the first tree, in the
+            // second set's random arrival order (a sorted walk would grow the intersection result into a chain)
+            TreeNode* first_root_ptr = build_tree_from_keys(first_keys);
+            auto baseline_start = std::chrono::steady_clock::now();
+            TreeNode* baseline_root_ptr = nullptr;
+            if (operation_index == 0) {
+                for (int key_value : second_keys) {
+                    insert_node_unique(first_root_ptr, key_value);
+                }
+                std::swap(baseline_root_ptr, first_root_ptr);
+            } else if (operation_index == 1) {
+                for (int key_value : second_keys) {
+                    if (search_node_value(first_root_ptr, key_value)) {
+                        insert_node_unique(baseline_root_ptr, key_value);
+                    }
+                }
+            } else {
+                for (int key_value : second_keys) {
+                    delete_node_value(first_root_ptr, key_value);
+                }
+                std::swap(baseline_root_ptr, first_root_ptr);
+            }
+            double baseline_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - baseline_start).count();
+            std::vector<int> baseline_result;
+            perform_inorder_traversal(baseline_root_ptr, baseline_result);
+            deallocate_tree_memory(baseline_root_ptr);
+            deallocate_tree_memory(first_root_ptr);
+            
+            // Join-based operation on fresh plain BSTs, first reshaped into treaps on the same nodes
+            first_root_ptr = build_tree_from_keys(first_keys);
+            TreeNode* second_root_ptr = build_tree_from_keys(second_keys);
+            auto convert_start = std::chrono::steady_clock::now();
+            first_root_ptr = convert_to_treap(first_root_ptr);
+            second_root_ptr = convert_to_treap(second_root_ptr);
+            double convert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - convert_start).count();
+            bool inputs_valid = treap_invariants_hold(first_root_ptr) && treap_invariants_hold(second_root_ptr);
+            auto join_start = std::chrono::steady_clock::now();
+            TreeNode* result_root_ptr = nullptr;
+            if (operation_index == 0) {
+                result_root_ptr = tree_union(first_root_ptr, second_root_ptr, worker_threads);
+            } else if (operation_index == 1) {
+                result_root_ptr = tree_intersection(first_root_ptr, second_root_ptr, worker_threads);
+            } else {
+                result_root_ptr = tree_difference(first_root_ptr, second_root_ptr, worker_threads);
+            }
+            double join_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - join_start).count();
+            std::vector<int> join_result;
+            perform_inorder_traversal(result_root_ptr, join_result);
+            int result_height = calculate_tree_height(result_root_ptr);
+            bool treaps_valid = inputs_valid && treap_invariants_hold(result_root_ptr);
+            deallocate_tree_memory(result_root_ptr);
+            
+            bool results_match = join_result == expected_keys && baseline_result == expected_keys;
+            console_output << "    " << operation_names[operation_index] << ": per-key " << FixedPrecision(baseline_ms, 2)
+                           << " ms, treap conversion " << FixedPrecision(convert_ms, 2) << " ms + join-based "
+                           << FixedPrecision(join_ms, 2) << " ms, " << join_result.size() << " keys, height " << result_height
+                           << (results_match ? "" : "  MISMATCH") << (treaps_valid ? "" : "  INVALID TREAP") << '\n';
+        }
+    }
+    console_output.flush();
+}
+
+// Split a treap into keys < split_key and keys >= split_key in O(log n), reusing every node
+void split_tree_by_key(TreeNode* root_ptr, int split_key, TreeNode*& left_root_ptr, TreeNode*& right_root_ptr) {
+    TreeNode* equal_node_ptr = nullptr;
+    split_treap(root_ptr, split_key, left_root_ptr, equal_node_ptr, right_root_ptr);
+    if (equal_node_ptr != nullptr) {
+        right_root_ptr = join_treaps(equal_node_ptr, right_root_ptr);
+    }
+}
+
+// Concatenate two treaps in O(log n); overlapping key ranges fall back to tree_union()
+TreeNode* join_trees(TreeNode* left_root_ptr, TreeNode* right_root_ptr) {
+    if (left_root_ptr == nullptr || right_root_ptr == nullptr) {
+        return left_root_ptr != nullptr ? left_root_ptr : right_root_ptr;
+    }
+    TreeNode* left_maximum_ptr = left_root_ptr;
+    while (left_maximum_ptr->right_child_ptr != nullptr) {
+        left_maximum_ptr = left_maximum_ptr->right_child_ptr;
+    }
+    TreeNode* right_minimum_ptr = right_root_ptr;
+    while (right_minimum_ptr->left_child_ptr != nullptr) {
+        right_minimum_ptr = right_minimum_ptr->left_child_ptr;
+    }
+    if (left_maximum_ptr->data_payload >= right_minimum_ptr->data_payload) {
+        return tree_union(left_root_ptr, right_root_ptr);
+    }
+    return join_treaps(left_root_ptr, right_root_ptr);
+}
+
+// Cut a treap into keys < range_low, keys in [range_low, range_high] and keys > range_high
+static void split_key_range(TreeNode* root_ptr, int range_low, int range_high, TreeNode*& below_range_ptr,
+                            TreeNode*& range_root_ptr, TreeNode*& above_range_ptr) {
+    TreeNode* from_range_ptr = nullptr;
+    split_tree_by_key(root_ptr, range_low, below_range_ptr, from_range_ptr);
+    
+    // Split above range_high without overflowing at INT_MAX
+    TreeNode* range_high_node_ptr = nullptr;
+    split_treap(from_range_ptr, range_high, range_root_ptr, range_high_node_ptr, above_range_ptr);
+    range_root_ptr = join_treaps(range_root_ptr, range_high_node_ptr);
+}
+
+// Move keys in [range_low, range_high] from one treap shard to another in O(log n): both shards are cut at the
+// range bounds and the adjacent pieces rejoined; only keys the destination already holds inside the range need a union
+void move_key_range(TreeNode*& source_root_ptr, TreeNode*& destination_root_ptr, int range_low, int range_high) {
+    if (range_low > range_high) {
+        return;
+    }
+    TreeNode* below_range_ptr = nullptr;
+    TreeNode* range_root_ptr = nullptr;
+    TreeNode* above_range_ptr = nullptr;
+    split_key_range(source_root_ptr, range_low, range_high, below_range_ptr, range_root_ptr, above_range_ptr);
+    source_root_ptr = join_trees(below_range_ptr, above_range_ptr);
+    
+    TreeNode* destination_below_ptr = nullptr;
+    TreeNode* destination_range_ptr = nullptr;
+    TreeNode* destination_above_ptr = nullptr;
+    split_key_range(destination_root_ptr, range_low, range_high, destination_below_ptr, destination_range_ptr,
+                    destination_above_ptr);
+    if (destination_range_ptr != nullptr) {
+        range_root_ptr = tree_union(destination_range_ptr, range_root_ptr, 1);
+    }
+    destination_root_ptr = join_trees(join_trees(destination_below_ptr, range_root_ptr), destination_above_ptr);
+}
+
+// Move the top tenth of one shard's range to its neighbour: split/join versus per-key delete and insert
+void run_reshard_benchmark(size_t key_count) {
+    const int shard_count = 4;
+    console_output << "Reshard benchmark with " << key_count << " keys over " << shard_count << " shards\n";
+    std::mt19937_64 random_engine(43);
+    std::vector<int> key_stream(key_count);
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        key_stream[key_index] = static_cast<int>(key_index);
+    }
+    std::shuffle(key_stream.begin(), key_stream.end(), random_engine);
+    
+    // Shard s owns [s * shard_width, (s + 1) * shard_width); shard 0 hands its top tenth to shard 1
+    int shard_width = static_cast<int>((key_count + shard_count - 1) / shard_count);
+    int range_low = shard_width - std::max(1, shard_width / 10);
+    int range_high = shard_width - 1;
+    
+    for (int method_index = 0; method_index < 2; method_index++) {
+        TreeNode* shard_roots[shard_count] = {};
+        for (int key_value : key_stream) {
+            treap_insert(shard_roots[key_value / shard_width], key_value);
+        }
+        
+        auto start_time = std::chrono::steady_clock::now();
+        if (method_index == 0) {
+            // Baseline: collect the range, delete each key from the source and insert it into the destination
+            std::vector<int> source_keys;
+            perform_inorder_traversal(shard_roots[0], source_keys);
+            for (int key_value : source_keys) {
+                if (key_value >= range_low && key_value <= range_high) {
+                    TreeNode* less_ptr = nullptr;
+                    TreeNode* moved_node_ptr = nullptr;
+                    TreeNode* greater_ptr = nullptr;
+                    split_treap(shard_roots[0], key_value, less_ptr, moved_node_ptr, greater_ptr);
+                    delete moved_node_ptr;
+                    shard_roots[0] = join_treaps(less_ptr, greater_ptr);
+                    treap_insert(shard_roots[1], key_value);
+                }
+            }
+        } else {
+            move_key_range(shard_roots[0], shard_roots[1], range_low, range_high);
+        }
+        double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+        
+        // Both shards must stay ordered, complete and shallow
+        std::vector<int> source_keys;
+        std::vector<int> destination_keys;
+        perform_inorder_traversal(shard_roots[0], source_keys);
+        perform_inorder_traversal(shard_roots[1], destination_keys);
+        bool shards_valid = !source_keys.empty() && source_keys.back() < range_low &&
+                            !destination_keys.empty() && destination_keys.front() == range_low &&
+                            std::is_sorted(destination_keys.begin(), destination_keys.end()) &&
+                            source_keys.size() + destination_keys.size() ==
+                                std::min<size_t>(key_count, 2 * static_cast<size_t>(shard_width));
+        console_output << "  " << (method_index == 0 ? "per-key move: " : "split/join:   ") << FixedPrecision(elapsed_ms, 3)
+                       << " ms, moved " << (range_high - range_low + 1) << " keys, shard heights "
+                       << calculate_tree_height(shard_roots[0]) << '/' << calculate_tree_height(shard_roots[1])
+                       << (shards_valid ? "" : "  INVALID") << '\n';
+        for (TreeNode* shard_root_ptr : shard_roots) {
+            deallocate_tree_memory(shard_root_ptr);
+        }
+    }
+    console_output.flush();
+}
+
+// Treap priority shared with the TreeNode treaps so both structures hash keys the same way
+static uint64_t ranked_priority(int key_value) {
+    return scramble_key_bits(static_cast<uint32_t>(key_value));
+}
+
+// Free every node with an explicit stack
+OrderStatisticTree::~OrderStatisticTree() {
+    std::vector<RankedTreeNode*> pending_nodes;
+    if (root_ptr != nullptr) {
+        pending_nodes.push_back(root_ptr);
+    }
+    while (!pending_nodes.empty()) {
+        RankedTreeNode* node_ptr = pending_nodes.back();
+        pending_nodes.pop_back();
+        if (node_ptr->left_child_ptr != nullptr) {
+            pending_nodes.push_back(node_ptr->left_child_ptr);
+        }
+        if (node_ptr->right_child_ptr != nullptr) {
+            pending_nodes.push_back(node_ptr->right_child_ptr);
+        }
+        delete node_ptr;
+    }
+}
+
+// Split into keys < split_key and keys >= split_key, repairing subtree sizes on the way back up
+void OrderStatisticTree::split_ranked(RankedTreeNode* node_ptr, int split_key, RankedTreeNode*& less_root_ptr,
+                                      RankedTreeNode*& greater_root_ptr) {
+    if (node_ptr == nullptr) {
+        less_root_ptr = nullptr;
+        greater_root_ptr = nullptr;
+        return;
+    }
+    if (node_ptr->data_payload < split_key) {
+        split_ranked(node_ptr->right_child_ptr, split_key, node_ptr->right_child_ptr, greater_root_ptr);
+        less_root_ptr = node_ptr;
+    } else {
+        split_ranked(node_ptr->left_child_ptr, split_key, less_root_ptr, node_ptr->left_child_ptr);
+        greater_root_ptr = node_ptr;
+    }
+    node_ptr->subtree_size = 1 + subtree_size(node_ptr->left_child_ptr) + subtree_size(node_ptr->right_child_ptr);
+}
+
+// Join two treaps whose key ranges do not overlap, repairing subtree sizes
+OrderStatisticTree::RankedTreeNode* OrderStatisticTree::join_ranked(RankedTreeNode* left_root_ptr,
+                                                                    RankedTreeNode* right_root_ptr) {
+    if (left_root_ptr == nullptr || right_root_ptr == nullptr) {
+        return left_root_ptr != nullptr ? left_root_ptr : right_root_ptr;
+    }
+    if (ranked_priority(left_root_ptr->data_payload) > ranked_priority(right_root_ptr->data_payload)) {
+        left_root_ptr->right_child_ptr = join_ranked(left_root_ptr->right_child_ptr, right_root_ptr);
+        left_root_ptr->subtree_size = 1 + subtree_size(left_root_ptr->left_child_ptr) + subtree_size(left_root_ptr->right_child_ptr);
+        return left_root_ptr;
+    }
+    right_root_ptr->left_child_ptr = join_ranked(left_root_ptr, right_root_ptr->left_child_ptr);
+    right_root_ptr->subtree_size = 1 + subtree_size(right_root_ptr->left_child_ptr) + subtree_size(right_root_ptr->right_child_ptr);
+    return right_root_ptr;
+}
+
+// Descend while ancestors outrank the new key (counting it into their sizes), then split beneath the new node
+bool OrderStatisticTree::insert_key(int insertion_value) {
+    for (RankedTreeNode* node_ptr = root_ptr; node_ptr != nullptr;) {
+        if (node_ptr->data_payload == insertion_value) {
+            return false;
+        }
+        node_ptr = insertion_value < node_ptr->data_payload ? node_ptr->left_child_ptr : node_ptr->right_child_ptr;
+    }
+    RankedTreeNode* new_node_ptr = new RankedTreeNode{insertion_value, 1, nullptr, nullptr};
+    uint64_t new_priority = ranked_priority(insertion_value);
+    RankedTreeNode** attach_link_ptr = &root_ptr;
+    while (*attach_link_ptr != nullptr && ranked_priority((*attach_link_ptr)->data_payload) > new_priority) {
+        (*attach_link_ptr)->subtree_size++;
+        attach_link_ptr = insertion_value < (*attach_link_ptr)->data_payload ? &(*attach_link_ptr)->left_child_ptr
+                                                                              : &(*attach_link_ptr)->right_child_ptr;
+    }
+    split_ranked(*attach_link_ptr, insertion_value, new_node_ptr->left_child_ptr, new_node_ptr->right_child_ptr);
+    new_node_ptr->subtree_size = 1 + subtree_size(new_node_ptr->left_child_ptr) + subtree_size(new_node_ptr->right_child_ptr);
+    *attach_link_ptr = new_node_ptr;
+    return true;
+}
+
+// Remove a key by joining its children in its place, discounting it from every ancestor
+bool OrderStatisticTree::erase_key(int target_value) {
+    RankedTreeNode* node_ptr = root_ptr;
+    while (node_ptr != nullptr && node_ptr->data_payload != target_value) {
+        node_ptr = target_value < node_ptr->data_payload ? node_ptr->left_child_ptr : node_ptr->right_child_ptr;
+    }
+    if (node_ptr == nullptr) {
+        return false;
+    }
+    RankedTreeNode** parent_link_ptr = &root_ptr;
+    while ((*parent_link_ptr)->data_payload != target_value) {
+        (*parent_link_ptr)->subtree_size--;
+        parent_link_ptr = target_value < (*parent_link_ptr)->data_payload ? &(*parent_link_ptr)->left_child_ptr
+                                                                         : &(*parent_link_ptr)->right_child_ptr;
+    }
+    *parent_link_ptr = join_ranked(node_ptr->left_child_ptr, node_ptr->right_child_ptr);
+    delete node_ptr;
+    return true;
+}
+
+size_t OrderStatisticTree::size() const {
+    return subtree_size(root_ptr);
+}
+
+// Walk down by left-subtree sizes
+int OrderStatisticTree::select_key(size_t key_rank) const {
+    const RankedTreeNode* node_ptr = root_ptr;
+    for (;;) {
+        size_t left_size = subtree_size(node_ptr->left_child_ptr);
+        if (key_rank < left_size) {
+            node_ptr = node_ptr->left_child_ptr;
+        } else if (key_rank == left_size) {
+            return node_ptr->data_payload;
+        } else {
+            key_rank -= left_size + 1;
+            node_ptr = node_ptr->right_child_ptr;
+        }
+    }
+}
+
+// Sum the left-subtree sizes passed on the way to key_value
+size_t OrderStatisticTree::count_keys_below(int key_value) const {
+    size_t key_rank = 0;
+    const RankedTreeNode* node_ptr = root_ptr;
+    while (node_ptr != nullptr) {
+        if (node_ptr->data_payload < key_value) {
+            key_rank += subtree_size(node_ptr->left_child_ptr) + 1;
+            node_ptr = node_ptr->right_child_ptr;
+        } else {
+            node_ptr = node_ptr->left_child_ptr;
+        }
+    }
+    return key_rank;
+}
+
+// Count, sum and sum of squares change only for keys new to the set
+void IncrementalStatistics::record_insert(int key_value) {
+    if (ranked_keys.insert_key(key_value)) {
+        sum_total += key_value;
+        sum_of_squares += static_cast<long double>(key_value) * key_value;
+    }
+}
+
+void IncrementalStatistics::record_delete(int key_value) {
+    if (ranked_keys.erase_key(key_value)) {
+        sum_total -= key_value;
+        sum_of_squares -= static_cast<long double>(key_value) * key_value;
+    }
+}
+
+// Same fields as compute_dataset_statistics() without touching every key
+DatasetStatistics IncrementalStatistics::current_statistics(TreeNode* root_ptr) const {
+    DatasetStatistics statistics;
+    size_t element_count = ranked_keys.size();
+    if (element_count == 0 || root_ptr == nullptr) {
+        return statistics;
+    }
+    statistics.element_count = element_count;
+    statistics.sum_total = sum_total;
+    statistics.mean_value = static_cast<double>(sum_total) / element_count;
     
-    // Predefined dataset for deterministic execution and testing
-    std::vector<int> input_dataset = {50, 30, 70, 20, 40, 60, 80, 10, 25, 35, 45, 55, 65, 75, 85};
-    int total_operations = input_dataset.size();
+    // Extremes sit at the ends of the leftmost and rightmost paths
+    TreeNode* leftmost_node_ptr = root_ptr;
+    while (leftmost_node_ptr->left_child_ptr != nullptr) {
+        leftmost_node_ptr = leftmost_node_ptr->left_child_ptr;
+    }
+    TreeNode* rightmost_node_ptr = root_ptr;
+    while (rightmost_node_ptr->right_child_ptr != nullptr) {
+        rightmost_node_ptr = rightmost_node_ptr->right_child_ptr;
+    }
+    statistics.minimum_value = leftmost_node_ptr->data_payload;
+    statistics.maximum_value = rightmost_node_ptr->data_payload;
+    statistics.value_range = static_cast<long long>(statistics.maximum_value) - statistics.minimum_value;
     
-    std::cout << "Phase 1: Tree Construction and Node Insertion\n";
-    std::cout << "---------------------------------------------\n";
+    statistics.median_value = (element_count % 2 == 0) ?
+        (static_cast<double>(ranked_keys.select_key(element_count / 2 - 1)) + ranked_keys.select_key(element_count / 2)) / 2.0 :
+        ranked_keys.select_key(element_count / 2);
+    return statistics;
+}
+
+double IncrementalStatistics::standard_deviation() const {
+    size_t element_count = ranked_keys.size();
+    if (element_count == 0) {
+        return 0.0;
+    }
+    long double mean_value = static_cast<long double>(sum_total) / element_count;
+    long double variance = sum_of_squares / element_count - mean_value * mean_value;
+    return std::sqrt(static_cast<double>(std::max(variance, 0.0L)));
+}
+
+// Statistics requested after every 1000 inserts (with interleaved deletes): rescan of the tree versus the running accumulator
+void run_incremental_statistics_benchmark(size_t key_count) {
+    const size_t request_interval = 1000;
+    const size_t delete_interval = 10;
+    console_output << "Incremental statistics benchmark with " << key_count << " inserts, statistics every "
+                   << request_interval << " inserts, one delete per " << delete_interval << " inserts\n";
+    console_output.flush();
+    std::mt19937_64 random_engine(44);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    std::vector<int> key_stream(key_count);
+    for (int& key_value : key_stream) {
+        key_value = key_distribution(random_engine);
+    }
     
-    // Iterative insertion process with progress tracking
-    for (int operation_index = 0; operation_index < total_operations; operation_index++) {
-        int current_value = input_dataset[operation_index];
-        
-        // Display current insertion operation
-        std::cout << "Inserting node with value: " << std::setw(3) << current_value << " ";
-        
-        // Perform node insertion into binary search tree
-        tree_root_ptr = insert_node_iterative(tree_root_ptr, current_value);
-        
-        // Display progress indicator for current operation
-        display_progress_indicator(operation_index + 1, total_operations);
-        std::cout << std::endl;
+    // Exact: traverse and recompute at each request
+    std::vector<DatasetStatistics> exact_results;
+    TreeNode* exact_root_ptr = nullptr;
+    std::vector<int> inorder_buffer;
+    auto exact_start = std::chrono::steady_clock::now();
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        insert_node_unique(exact_root_ptr, key_stream[key_index]);
+        if ((key_index + 1) % delete_interval == 0) {
+            delete_node_value(exact_root_ptr, key_stream[key_index / 2]);
+        }
+        if ((key_index + 1) % request_interval == 0) {
+            inorder_buffer.clear();
+            perform_inorder_traversal(exact_root_ptr, inorder_buffer);
+            exact_results.push_back(compute_dataset_statistics(inorder_buffer));
+        }
     }
+    double exact_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - exact_start).count();
+    deallocate_tree_memory(exact_root_ptr);
     
-    std::cout << "\nPhase 2: Tree Structure Analysis\n";
-    std::cout << "--------------------------------\n";
+    // Incremental: the driver's insert and delete paths update the accumulator, read at each request
+    std::vector<DatasetStatistics> incremental_results;
+    DriverTreeState tree_state;
+    tree_state.running_statistics.enable();
+    auto incremental_start = std::chrono::steady_clock::now();
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        insert_workload_key(tree_state, key_stream[key_index]);
+        if ((key_index + 1) % delete_interval == 0) {
+            delete_workload_key(tree_state, key_stream[key_index / 2]);
+        }
+        if ((key_index + 1) % request_interval == 0) {
+            incremental_results.push_back(tree_state.running_statistics.current_statistics(tree_state.root_ptr));
+        }
+    }
+    double incremental_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - incremental_start).count();
+    deallocate_tree_memory(tree_state.root_ptr);
     
-    // Calculate and display tree metrics
-    int tree_height = calculate_tree_height(tree_root_ptr);
-    int node_count = count_total_nodes(tree_root_ptr);
+    size_t mismatched_requests = 0;
+    for (size_t request_index = 0; request_index < exact_results.size(); request_index++) {
+        const DatasetStatistics& exact_statistics = exact_results[request_index];
+        const DatasetStatistics& incremental_statistics = incremental_results[request_index];
+        if (exact_statistics.element_count != incremental_statistics.element_count ||
+            exact_statistics.sum_total != incremental_statistics.sum_total ||
+            exact_statistics.median_value != incremental_statistics.median_value ||
+            exact_statistics.minimum_value != incremental_statistics.minimum_value ||
+            exact_statistics.maximum_value != incremental_statistics.maximum_value) {
+            mismatched_requests++;
+        }
+    }
+    console_output << "  rescan:      " << FixedPrecision(exact_ms, 1) << " ms for " << exact_results.size() << " requests\n";
+    console_output << "  incremental: " << FixedPrecision(incremental_ms, 1) << " ms (" << mismatched_requests
+                   << " mismatched requests)\n";
+    console_output.flush();
+}
+
+// Nearest-rank quantile: the smallest key with at least quantile * n keys at or below it (0-based rank)
+size_t quantile_rank(double quantile, size_t element_count) {
+    double rank_bound = std::ceil(quantile * static_cast<double>(element_count));
+    size_t key_rank = rank_bound < 1.0 ? 0 : static_cast<size_t>(rank_bound) - 1;
+    return std::min(key_rank, element_count - 1);
+}
+
+// One O(log n) select on the size-augmented tree; requires a non-empty tree
+int select_quantile(const OrderStatisticTree& ranked_keys, double quantile) {
+    return ranked_keys.select_key(quantile_rank(quantile, ranked_keys.size()));
+}
+
+// Child visited first (near) and last (far) in a Morris walk; descending walks mirror the tree
+template <bool Descending> static TreeNode*& near_child(TreeNode* node_ptr) {
+    return Descending ? node_ptr->right_child_ptr : node_ptr->left_child_ptr;
+}
+template <bool Descending> static TreeNode*& far_child(TreeNode* node_ptr) {
+    return Descending ? node_ptr->left_child_ptr : node_ptr->right_child_ptr;
+}
+
+// Remove the threads a Morris walk left behind when it stopped right after visiting stop_value: every ancestor
+// whose near subtree holds stop_value still has a thread from its in-order neighbour
+template <bool Descending> static void remove_morris_threads(TreeNode* root_ptr, int stop_value) {
+    TreeNode* ancestor_ptr = root_ptr;
+    while (ancestor_ptr != nullptr && ancestor_ptr->data_payload != stop_value) {
+        bool stop_is_near = Descending ? stop_value > ancestor_ptr->data_payload : stop_value < ancestor_ptr->data_payload;
+        if (stop_is_near) {
+            TreeNode* neighbour_ptr = near_child<Descending>(ancestor_ptr);
+            while (far_child<Descending>(neighbour_ptr) != ancestor_ptr) {
+                neighbour_ptr = far_child<Descending>(neighbour_ptr);
+            }
+            far_child<Descending>(neighbour_ptr) = nullptr;
+            ancestor_ptr = near_child<Descending>(ancestor_ptr);
+        } else {
+            ancestor_ptr = far_child<Descending>(ancestor_ptr);
+        }
+    }
+}
+
+// Morris in-order walk with O(1) extra memory that stops once visit_key returns false and restores the tree.
+// The tree is temporarily rethreaded, so no other thread may read it during the walk
+template <bool Descending, typename KeyVisitor>
+static void partial_morris_walk(TreeNode* root_ptr, KeyVisitor&& visit_key) {
+    TreeNode* current_node_ptr = root_ptr;
+    while (current_node_ptr != nullptr) {
+        TreeNode* near_subtree_ptr = near_child<Descending>(current_node_ptr);
+        if (near_subtree_ptr == nullptr) {
+            if (!visit_key(current_node_ptr->data_payload)) {
+                remove_morris_threads<Descending>(root_ptr, current_node_ptr->data_payload);
+                return;
+            }
+            current_node_ptr = far_child<Descending>(current_node_ptr);
+            continue;
+        }
+        
+        // Thread the in-order neighbour back to this node on the way down; unthread on the way back
+        TreeNode* neighbour_ptr = near_subtree_ptr;
+        while (far_child<Descending>(neighbour_ptr) != nullptr && far_child<Descending>(neighbour_ptr) != current_node_ptr) {
+            neighbour_ptr = far_child<Descending>(neighbour_ptr);
+        }
+        if (far_child<Descending>(neighbour_ptr) == nullptr) {
+            far_child<Descending>(neighbour_ptr) = current_node_ptr;
+            current_node_ptr = near_subtree_ptr;
+        } else {
+            far_child<Descending>(neighbour_ptr) = nullptr;
+            if (!visit_key(current_node_ptr->data_payload)) {
+                remove_morris_threads<Descending>(root_ptr, current_node_ptr->data_payload);
+                return;
+            }
+            current_node_ptr = far_child<Descending>(current_node_ptr);
+        }
+    }
+}
+
+// Batch quantiles from one partial in-order walk, entered from whichever end reaches every requested rank sooner
+std::vector<int> tree_quantiles(TreeNode* root_ptr, size_t node_count, const std::vector<double>& quantiles) {
+    std::vector<int> quantile_values(quantiles.size());
+    if (root_ptr == nullptr || node_count == 0 || quantiles.empty()) {
+        return quantile_values;
+    }
     
-    std::cout << "Tree Height (Maximum Depth): " << tree_height << std::endl;
-    std::cout << "Total Node Count: " << node_count << std::endl;
-    std::cout << "Tree Balance Factor: " << std::fixed << std::setprecision(2) 
-              << (double)node_count / (double)tree_height << std::endl;
+    // Requested ranks, sorted, remembering which quantile each answers
+    std::vector<std::pair<size_t, size_t>> rank_requests;
+    for (size_t quantile_index = 0; quantile_index < quantiles.size(); quantile_index++) {
+        rank_requests.push_back({quantile_rank(quantiles[quantile_index], node_count), quantile_index});
+    }
+    std::sort(rank_requests.begin(), rank_requests.end());
+    size_t ascending_steps = rank_requests.back().first + 1;
+    size_t descending_steps = node_count - rank_requests.front().first;
     
-    std::cout << "\nPhase 3: Tree Traversal Operations\n";
-    std::cout << "----------------------------------\n";
+    if (ascending_steps <= descending_steps) {
+        size_t key_rank = 0;
+        size_t next_request = 0;
+        partial_morris_walk<false>(root_ptr, [&](int key_value) {
+            while (next_request < rank_requests.size() && rank_requests[next_request].first == key_rank) {
+                quantile_values[rank_requests[next_request].second] = key_value;
+                next_request++;
+            }
+            key_rank++;
+            return next_request < rank_requests.size();
+        });
+    } else {
+        size_t key_rank = node_count - 1;
+        size_t next_request = rank_requests.size();
+        partial_morris_walk<true>(root_ptr, [&](int key_value) {
+            while (next_request > 0 && rank_requests[next_request - 1].first == key_rank) {
+                quantile_values[rank_requests[next_request - 1].second] = key_value;
+                next_request--;
+            }
+            key_rank--;
+            return next_request > 0;
+        });
+    }
+    return quantile_values;
+}
+
+// p50/p90/p99/p99.9: copy-and-sort versus one partial Morris walk versus O(log n) selects
+void run_quantile_benchmark(size_t key_count) {
+    const std::vector<double> benchmark_quantiles = {0.5, 0.9, 0.99, 0.999};
+    console_output << "Quantile benchmark with " << key_count << " random keys (p50, p90, p99, p99.9)\n";
+    console_output.flush();
+    std::mt19937_64 random_engine(45);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    TreeNode* root_ptr = nullptr;
+    OrderStatisticTree ranked_keys;
+    size_t node_count = 0;
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        int key_value = key_distribution(random_engine);
+        node_count += insert_node_unique(root_ptr, key_value);
+        ranked_keys.insert_key(key_value);
+    }
     
-    // Perform inorder traversal and collect results
-    std::vector<int> inorder_results;
-    perform_inorder_traversal(tree_root_ptr, inorder_results);
-    display_traversal_results(inorder_results, "In-Order");
+    // Baseline: materialize the traversal and sort a copy, as compute_dataset_statistics() does for the median
+    auto sort_start = std::chrono::steady_clock::now();
+    std::vector<int> sorted_keys;
+    perform_inorder_traversal(root_ptr, sorted_keys);
+    std::vector<int> sorted_copy = sorted_keys;
+    std::sort(sorted_copy.begin(), sorted_copy.end());
+    std::vector<int> sorted_values;
+    for (double quantile : benchmark_quantiles) {
+        sorted_values.push_back(sorted_copy[quantile_rank(quantile, sorted_copy.size())]);
+    }
+    double sort_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sort_start).count();
     
-    // Perform preorder traversal and collect results
-    std::vector<int> preorder_results;
-    perform_preorder_traversal(tree_root_ptr, preorder_results);
-    display_traversal_results(preorder_results, "Pre-Order");
+    auto walk_start = std::chrono::steady_clock::now();
+    std::vector<int> walk_values = tree_quantiles(root_ptr, node_count, benchmark_quantiles);
+    double walk_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - walk_start).count();
     
-    // Perform postorder traversal and collect results
-    std::vector<int> postorder_results;
-    perform_postorder_traversal(tree_root_ptr, postorder_results);
-    display_traversal_results(postorder_results, "Post-Order");
+    const size_t select_rounds = 1000;
+    std::vector<int> select_values(benchmark_quantiles.size());
+    auto select_start = std::chrono::steady_clock::now();
+    for (size_t round_index = 0; round_index < select_rounds; round_index++) {
+        for (size_t quantile_index = 0; quantile_index < benchmark_quantiles.size(); quantile_index++) {
+            select_values[quantile_index] = select_quantile(ranked_keys, benchmark_quantiles[quantile_index]);
+        }
+    }
+    double select_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - select_start).count() /
+                       (select_rounds * benchmark_quantiles.size());
     
-    std::cout << "\nPhase 4: Search Operations and Validation\n";
-    std::cout << "----------------------------------------\n";
+    // The partial walk must leave the tree exactly as it found it
+    std::vector<int> inorder_after_walk;
+    perform_inorder_traversal(root_ptr, inorder_after_walk);
+    bool tree_restored = inorder_after_walk == sorted_keys;
+    bool values_match = walk_values == sorted_values && select_values == sorted_values;
     
-    // Test search functionality with various values
-    std::vector<int> search_targets = {25, 75, 100, 1, 50};
+    console_output << "  traverse + sort:     " << FixedPrecision(sort_ms, 2) << " ms\n";
+    console_output << "  partial Morris walk: " << FixedPrecision(walk_ms, 2) << " ms, O(1) extra memory"
+                   << (tree_restored ? "" : ", TREE NOT RESTORED") << '\n';
+    console_output << "  order-statistic select: " << FixedPrecision(select_ns, 1) << " ns/quantile\n";
+    console_output << "  p50 " << sorted_values[0] << ", p90 " << sorted_values[1] << ", p99 " << sorted_values[2]
+                   << ", p99.9 " << sorted_values[3] << (values_match ? "" : "  MISMATCH") << '\n';
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
+}
+
+// k grows as 1/epsilon; 1.65/k is the empirical single-quantile rank error of KLL with c = 2/3
+KllQuantileSketch::KllQuantileSketch(double rank_error)
+    : target_rank_error(rank_error),
+      sketch_k(std::max<size_t>(8, static_cast<size_t>(std::ceil(1.65 / rank_error)))),
+      compactor_levels(1) {
+    refresh_capacity();
+}
+
+// Top level holds k items; each level below holds two thirds of the one above, never fewer than 8
+size_t KllQuantileSketch::level_capacity(size_t level_index) const {
+    size_t levels_above = compactor_levels.size() - 1 - level_index;
+    double scaled_capacity = std::ceil(static_cast<double>(sketch_k) * std::pow(2.0 / 3.0, static_cast<double>(levels_above)));
+    return std::max<size_t>(8, static_cast<size_t>(scaled_capacity));
+}
+
+void KllQuantileSketch::refresh_capacity() {
+    capacity_budget = 0;
+    for (size_t level_index = 0; level_index < compactor_levels.size(); level_index++) {
+        capacity_budget += level_capacity(level_index);
+    }
+}
+
+void KllQuantileSketch::insert_value(int value) {
+    compactor_levels[0].push_back(value);
+    total_count++;
+    retained_items++;
+    if (retained_items >= capacity_budget) {
+        compress_levels();
+    }
+}
+
+// Sort one level and promote every other item (random offset) with doubled weight
+void KllQuantileSketch::compact_level(size_t level_index) {
+    if (level_index + 1 == compactor_levels.size()) {
+        compactor_levels.emplace_back();
+        refresh_capacity();
+    }
+    std::vector<int>& level_items = compactor_levels[level_index];
+    std::vector<int>& next_level_items = compactor_levels[level_index + 1];
+    std::sort(level_items.begin(), level_items.end());
     
-    for (int target_value : search_targets) {
-        bool search_result = search_node_value(tree_root_ptr, target_value);
-        std::cout << "Search for value " << std::setw(3) << target_value << ": " 
-                  << (search_result ? "FOUND" : "NOT FOUND") << std::endl;
+    // An odd item stays behind so total weight is preserved exactly
+    size_t kept_items = level_items.size() % 2;
+    coin_state = scramble_key_bits(coin_state);
+    size_t promote_offset = kept_items + (coin_state & 1);
+    size_t promoted_items = 0;
+    for (size_t item_index = promote_offset; item_index < level_items.size(); item_index += 2) {
+        next_level_items.push_back(level_items[item_index]);
+        promoted_items++;
+    }
+    retained_items -= level_items.size() - kept_items - promoted_items;
+    level_items.resize(kept_items);
+}
+
+// While over budget, compact the lowest level that has reached its own capacity
+void KllQuantileSketch::compress_levels() {
+    while (retained_items >= capacity_budget) {
+        size_t level_index = 0;
+        while (compactor_levels[level_index].size() < level_capacity(level_index)) {
+            level_index++;
+        }
+        compact_level(level_index);
+    }
+}
+
+// Level-wise concatenation followed by compaction keeps the same error guarantee
+void KllQuantileSketch::merge_from(const KllQuantileSketch& other_sketch) {
+    if (other_sketch.compactor_levels.size() > compactor_levels.size()) {
+        compactor_levels.resize(other_sketch.compactor_levels.size());
+        refresh_capacity();
+    }
+    for (size_t level_index = 0; level_index < other_sketch.compactor_levels.size(); level_index++) {
+        const std::vector<int>& other_items = other_sketch.compactor_levels[level_index];
+        compactor_levels[level_index].insert(compactor_levels[level_index].end(), other_items.begin(), other_items.end());
+    }
+    total_count += other_sketch.total_count;
+    retained_items += other_sketch.retained_items;
+    compress_levels();
+}
+
+// Sort the weighted items and return the first whose cumulative weight reaches the nearest rank
+int KllQuantileSketch::quantile_value(double quantile) const {
+    std::vector<std::pair<int, uint64_t>> weighted_items;
+    weighted_items.reserve(retained_item_count());
+    for (size_t level_index = 0; level_index < compactor_levels.size(); level_index++) {
+        for (int value : compactor_levels[level_index]) {
+            weighted_items.push_back({value, uint64_t(1) << level_index});
+        }
+    }
+    std::sort(weighted_items.begin(), weighted_items.end());
+    uint64_t target_weight = quantile_rank(quantile, total_count) + 1;
+    uint64_t cumulative_weight = 0;
+    for (const std::pair<int, uint64_t>& weighted_item : weighted_items) {
+        cumulative_weight += weighted_item.second;
+        if (cumulative_weight >= target_weight) {
+            return weighted_item.first;
+        }
+    }
+    return weighted_items.back().first;
+}
+
+void StreamingStatistics::record_value(int value) {
+    sum_total += value;
+    minimum_value = std::min(minimum_value, value);
+    maximum_value = std::max(maximum_value, value);
+    quantile_sketch.insert_value(value);
+}
+
+void StreamingStatistics::merge_from(const StreamingStatistics& other_statistics) {
+    sum_total += other_statistics.sum_total;
+    minimum_value = std::min(minimum_value, other_statistics.minimum_value);
+    maximum_value = std::max(maximum_value, other_statistics.maximum_value);
+    quantile_sketch.merge_from(other_statistics.quantile_sketch);
+}
+
+// Exact moments and extremes; the median is the sketch's nearest-rank estimate
+DatasetStatistics StreamingStatistics::summary() const {
+    DatasetStatistics statistics;
+    uint64_t element_count = quantile_sketch.value_count();
+    if (element_count == 0) {
+        return statistics;
+    }
+    statistics.element_count = element_count;
+    statistics.sum_total = sum_total;
+    statistics.mean_value = static_cast<double>(sum_total) / element_count;
+    statistics.median_value = quantile_sketch.quantile_value(0.5);
+    statistics.median_is_estimate = true;
+    statistics.minimum_value = minimum_value;
+    statistics.maximum_value = maximum_value;
+    statistics.value_range = static_cast<long long>(maximum_value) - minimum_value;
+    return statistics;
+}
+
+// Summarize a key stream with one sketch per worker thread, merged at the end
+StreamingStatistics summarize_key_stream(const std::vector<int>& key_stream, double rank_error, unsigned thread_count) {
+    unsigned worker_threads = resolve_worker_thread_count(thread_count);
+    if (key_stream.size() < 65536) {
+        worker_threads = 1;
     }
+    std::vector<StreamingStatistics> partial_statistics(worker_threads, StreamingStatistics(rank_error));
+    std::vector<std::thread> worker_pool;
+    size_t chunk_size = (key_stream.size() + worker_threads - 1) / worker_threads;
+    for (unsigned worker_index = 0; worker_index < worker_threads; worker_index++) {
+        worker_pool.emplace_back([&, worker_index]() {
+            size_t chunk_begin = std::min(key_stream.size(), worker_index * chunk_size);
+            size_t chunk_end = std::min(key_stream.size(), chunk_begin + chunk_size);
+            for (size_t key_index = chunk_begin; key_index < chunk_end; key_index++) {
+                partial_statistics[worker_index].record_value(key_stream[key_index]);
+            }
+        });
+    }
+    for (std::thread& worker_thread : worker_pool) {
+        worker_thread.join();
+    }
+    for (unsigned worker_index = 1; worker_index < worker_threads; worker_index++) {
+        partial_statistics[0].merge_from(partial_statistics[worker_index]);
+    }
+    return partial_statistics[0];
+}
+
+// Generated uniform stream: per-thread sketches merged versus an exact tree (only up to exact_tree_limit inputs)
+void run_sketch_benchmark(size_t value_count) {
+    const size_t exact_tree_limit = 5000000;
+    const double sketch_rank_error = 0.01;
+    const uint32_t value_span = 1u << 30;
+    unsigned worker_threads = resolve_worker_thread_count(0);
+    console_output << "Sketch benchmark with " << value_count << " uniform values in [0, 2^30), " << worker_threads
+                   << " thread(s), rank error " << sketch_rank_error << '\n';
+    console_output.flush();
     
-    std::cout << "\nPhase 5: Statistical Analysis\n";
-    std::cout << "----------------------------\n";
+    // Each worker generates and summarizes its own share of the stream
+    std::vector<StreamingStatistics> partial_statistics(worker_threads, StreamingStatistics(sketch_rank_error));
+    std::vector<std::thread> worker_pool;
+    auto sketch_start = std::chrono::steady_clock::now();
+    for (unsigned worker_index = 0; worker_index < worker_threads; worker_index++) {
+        worker_pool.emplace_back([&, worker_index]() {
+            std::mt19937_64 random_engine(46 + worker_index);
+            size_t share_count = value_count / worker_threads + (worker_index < value_count % worker_threads ? 1 : 0);
+            for (size_t value_index = 0; value_index < share_count; value_index++) {
+                partial_statistics[worker_index].record_value(static_cast<int>(random_engine() & (value_span - 1)));
+            }
+        });
+    }
+    for (std::thread& worker_thread : worker_pool) {
+        worker_thread.join();
+    }
+    for (unsigned worker_index = 1; worker_index < worker_threads; worker_index++) {
+        partial_statistics[0].merge_from(partial_statistics[worker_index]);
+    }
+    double sketch_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sketch_start).count();
+    const StreamingStatistics& stream_statistics = partial_statistics[0];
+    DatasetStatistics sketch_summary = stream_statistics.summary();
     
-    // Perform comprehensive statistical analysis on the dataset
-    perform_statistical_analysis(inorder_results);
+    console_output << "  sketch: " << FixedPrecision(value_count / sketch_seconds / 1e6, 1) << " M values/s, "
+                   << stream_statistics.sketch().retained_item_count() * sizeof(int) << " bytes retained, mean "
+                   << FixedPrecision(sketch_summary.mean_value, 1) << '\n';
     
-    std::cout << "\nPhase 6: Memory Management\n";
-    std::cout << "-------------------------\n";
+    // Rank error against the known uniform distribution
+    const double check_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    console_output << "  estimated quantiles (rank error vs uniform):";
+    for (double quantile : check_quantiles) {
+        int estimate = stream_statistics.sketch().quantile_value(quantile);
+        double rank_error = std::fabs(static_cast<double>(estimate) / value_span - quantile);
+        console_output << " q" << quantile << ' ' << FixedPrecision(100.0 * rank_error, 3) << '%';
+    }
+    console_output << '\n';
     
-    // Deallocate all dynamically allocated memory
-    deallocate_tree_memory(tree_root_ptr);
-    std::cout << "Tree memory successfully deallocated.\n";
+    if (value_count > exact_tree_limit) {
+        console_output << "  exact tree: skipped above " << exact_tree_limit << " values (would hold about "
+                       << value_count * sizeof(TreeNode) / (1024 * 1024) << " MiB of nodes)\n";
+        console_output.flush();
+        return;
+    }
     
-    std::cout << "\n========================================\n";
-    std::cout << "   Binary Tree Demo Completed Successfully\n";
-    std::cout << "   All operations executed without errors\n";
-    std::cout << "========================================\n";
+    // Exact baseline: build the tree from the same stream and scan it
+    uint64_t node_bytes_before = allocation_ledger.node_bytes.load(std::memory_order_relaxed);
+    auto exact_start = std::chrono::steady_clock::now();
+    TreeNode* root_ptr = nullptr;
+    for (unsigned worker_index = 0; worker_index < worker_threads; worker_index++) {
+        std::mt19937_64 random_engine(46 + worker_index);
+        size_t share_count = value_count / worker_threads + (worker_index < value_count % worker_threads ? 1 : 0);
+        for (size_t value_index = 0; value_index < share_count; value_index++) {
+            insert_node_unique(root_ptr, static_cast<int>(random_engine() & (value_span - 1)));
+        }
+    }
+    std::vector<int> inorder_results;
+    perform_inorder_traversal(root_ptr, inorder_results);
+    DatasetStatistics exact_statistics = compute_dataset_statistics(inorder_results);
+    double exact_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - exact_start).count();
+    uint64_t tree_bytes = allocation_ledger.node_bytes.load(std::memory_order_relaxed) - node_bytes_before;
     
-    return 0;
+    // Sketch median's rank within the distinct keys the tree holds
+    size_t median_rank = std::lower_bound(inorder_results.begin(), inorder_results.end(), static_cast<int>(sketch_summary.median_value)) -
+                         inorder_results.begin();
+    console_output << "  exact tree: " << FixedPrecision(value_count / exact_seconds / 1e6, 1) << " M values/s, "
+                   << tree_bytes + inorder_results.capacity() * sizeof(int) << " bytes, median "
+                   << FixedPrecision(exact_statistics.median_value, 1) << " vs sketch " << FixedPrecision(sketch_summary.median_value, 1)
+                   << " (rank error " << FixedPrecision(100.0 * std::fabs(static_cast<double>(median_rank) / inorder_results.size() - 0.5), 3)
+                   << "%)\n";
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
 }
 
-// Iterative insertion function for binary search tree construction
-TreeNode* insert_node_iterative(TreeNode* root_ptr, int insertion_value) {
-    // Create new node with specified value
-    TreeNode* new_node_ptr = new TreeNode(insertion_value);
-    
-    // Handle case where tree is empty (first insertion)
-    if (root_ptr == nullptr) {
-        return new_node_ptr;
+// Sum over the tree: inlined visitor versus materialized traversal + loop, plus an early-terminating scan
+void run_visitor_benchmark(size_t key_count) {
+    std::mt19937 random_engine(47);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    TreeNode* root_ptr = nullptr;
+    size_t node_count = 0;
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        node_count += insert_node_unique(root_ptr, key_distribution(random_engine));
     }
+    int repetitions = static_cast<int>(std::max<size_t>(1, 4000000 / std::max<size_t>(node_count, 1)));
+    console_output << "Visitor benchmark with " << node_count << " nodes, " << repetitions << " repetitions\n";
     
-    // Initialize traversal pointers for iterative insertion
-    TreeNode* current_node_ptr = root_ptr;
-    TreeNode* parent_node_ptr = nullptr;
-    
-    // Traverse tree to find appropriate insertion position
-    while (current_node_ptr != nullptr) {
-        parent_node_ptr = current_node_ptr;
-        
-        // Navigate left subtree for smaller values
-        if (insertion_value < current_node_ptr->data_payload) {
-            current_node_ptr = current_node_ptr->left_child_ptr;
-        }
-        // Navigate right subtree for larger values
-        else if (insertion_value > current_node_ptr->data_payload) {
-            current_node_ptr = current_node_ptr->right_child_ptr;
-        }
-        // Handle duplicate values (ignore insertion)
-        else {
-            delete new_node_ptr;
-            return root_ptr;
+    // Baseline: collect the in-order vector, then sum it
+    long long vector_sum = 0;
+    auto vector_start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        std::vector<int> inorder_results;
+        inorder_results.reserve(node_count);
+        perform_inorder_traversal(root_ptr, inorder_results);
+        for (int key_value : inorder_results) {
+            vector_sum += key_value;
         }
     }
+    double vector_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - vector_start).count();
     
-    // Insert new node at appropriate position
-    if (insertion_value < parent_node_ptr->data_payload) {
-        parent_node_ptr->left_child_ptr = new_node_ptr;
-    } else {
-        parent_node_ptr->right_child_ptr = new_node_ptr;
+    // Visitor: sum while walking, no intermediate buffer
+    long long visitor_sum = 0;
+    auto visitor_start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        visit_inorder(root_ptr, [&visitor_sum](int key_value) {
+            visitor_sum += key_value;
+            return true;
+        });
     }
+    double visitor_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - visitor_start).count();
     
-    return root_ptr;
+    // Early termination: count keys below zero and stop at the first non-negative key
+    size_t negative_count = 0;
+    auto early_start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        negative_count = 0;
+        visit_inorder(root_ptr, [&negative_count](int key_value) {
+            if (key_value >= 0) {
+                return false;
+            }
+            negative_count++;
+            return true;
+        });
+    }
+    double early_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - early_start).count();
+    
+    double nodes_visited = static_cast<double>(node_count) * repetitions;
+    console_output << "  traversal + loop: " << FixedPrecision(vector_seconds * 1e9 / nodes_visited, 2) << " ns/node ("
+                   << node_count * sizeof(int) << " byte buffer per walk)\n";
+    console_output << "  visitor:          " << FixedPrecision(visitor_seconds * 1e9 / nodes_visited, 2) << " ns/node, "
+                   << (visitor_sum == vector_sum ? "sums match" : "SUM MISMATCH") << '\n';
+    console_output << "  early stop:       " << FixedPrecision(early_seconds * 1e6 / repetitions, 2) << " us/walk for "
+                   << negative_count << " negative keys (" << node_count << " total)\n";
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
 }
 
-// Recursive inorder traversal implementation (Left-Root-Right)
-void perform_inorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
-    // Base case: null node encountered
-    if (current_node == nullptr) {
-        return;
+// Six separate walks (height, count, three orders, statistics scan) versus one fused walk
+void run_fused_analysis_benchmark(size_t key_count) {
+    std::mt19937 random_engine(48);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    TreeNode* root_ptr = nullptr;
+    size_t node_count = 0;
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        node_count += insert_node_unique(root_ptr, key_distribution(random_engine));
     }
+    int repetitions = static_cast<int>(std::max<size_t>(1, 2000000 / std::max<size_t>(node_count, 1)));
+    console_output << "Fused analysis benchmark with " << node_count << " nodes, " << repetitions << " repetitions\n";
     
-    // Recursively process left subtree
-    perform_inorder_traversal(current_node->left_child_ptr, traversal_results);
+    // Separate: what the phases did before fusion, each walk reading every node again
+    long long separate_checksum = 0;
+    auto separate_start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        int tree_height = calculate_tree_height(root_ptr);
+        int counted_nodes = count_total_nodes(root_ptr);
+        std::vector<int> inorder_results;
+        std::vector<int> preorder_results;
+        std::vector<int> postorder_results;
+        inorder_results.reserve(node_count);
+        preorder_results.reserve(node_count);
+        postorder_results.reserve(node_count);
+        perform_inorder_traversal(root_ptr, inorder_results);
+        perform_preorder_traversal(root_ptr, preorder_results);
+        perform_postorder_traversal(root_ptr, postorder_results);
+        DatasetStatistics statistics = compute_dataset_statistics(inorder_results);
+        separate_checksum += tree_height + counted_nodes + statistics.sum_total;
+    }
+    double separate_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - separate_start).count();
     
-    // Process current node data
-    traversal_results.push_back(current_node->data_payload);
+    // Fused: one walk
+    long long fused_checksum = 0;
+    auto fused_start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        TreeAnalysis tree_analysis = analyze_tree_single_pass(root_ptr, node_count);
+        fused_checksum += tree_analysis.tree_height + static_cast<long long>(tree_analysis.node_count) + tree_analysis.statistics.sum_total;
+    }
+    double fused_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fused_start).count();
     
-    // Recursively process right subtree
-    perform_inorder_traversal(current_node->right_child_ptr, traversal_results);
+    bool results_match = fused_checksum == separate_checksum &&
+                         tree_analysis_matches(root_ptr, analyze_tree_single_pass(root_ptr, node_count));
+    console_output << "  separate (6 walks): " << FixedPrecision(separate_seconds * 1e6 / repetitions, 2) << " us\n";
+    console_output << "  fused (1 walk):     " << FixedPrecision(fused_seconds * 1e6 / repetitions, 2) << " us ("
+                   << FixedPrecision(separate_seconds / fused_seconds, 2) << "x), "
+                   << (results_match ? "results match" : "RESULT MISMATCH") << '\n';
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
 }
 
-// Recursive preorder traversal implementation (Root-Left-Right)
-void perform_preorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
-    // Base case: null node encountered
-    if (current_node == nullptr) {
-        return;
-    }
-    
-    // Process current node data first
-    traversal_results.push_back(current_node->data_payload);
+// Register a task and derive its edges from tree access
+size_t PhaseTaskGraph::add_task(const char* task_name, TreeAccess tree_access, std::function<void()> task_body,
+                                const std::vector<size_t>& extra_dependencies) {
+    size_t task_index = phase_tasks.size();
+    phase_tasks.push_back(PhaseTask());
+    phase_tasks[task_index].task_name = task_name;
+    phase_tasks[task_index].task_body = std::move(task_body);
     
-    // Recursively process left subtree
-    perform_preorder_traversal(current_node->left_child_ptr, traversal_results);
-    
-    // Recursively process right subtree
-    perform_preorder_traversal(current_node->right_child_ptr, traversal_results);
+    if (tree_access != TreeAccess::none && last_exclusive_task != SIZE_MAX) {
+        add_dependency(last_exclusive_task, task_index);
+    }
+    if (tree_access == TreeAccess::shared) {
+        shared_since_exclusive.push_back(task_index);
+    } else if (tree_access == TreeAccess::exclusive) {
+        for (size_t shared_task : shared_since_exclusive) {
+            add_dependency(shared_task, task_index);
+        }
+        shared_since_exclusive.clear();
+        last_exclusive_task = task_index;
+    }
+    for (size_t prerequisite_index : extra_dependencies) {
+        add_dependency(prerequisite_index, task_index);
+    }
+    return task_index;
 }
 
-// Recursive postorder traversal implementation (Left-Right-Root)
-void perform_postorder_traversal(TreeNode* current_node, std::vector<int>& traversal_results) {
-    // Base case: null node encountered
-    if (current_node == nullptr) {
-        return;
+void PhaseTaskGraph::add_dependency(size_t prerequisite_index, size_t dependent_index) {
+    std::vector<size_t>& dependent_tasks = phase_tasks[prerequisite_index].dependent_tasks;
+    if (std::find(dependent_tasks.begin(), dependent_tasks.end(), dependent_index) == dependent_tasks.end()) {
+        dependent_tasks.push_back(dependent_index);
+        phase_tasks[dependent_index].dependency_count++;
     }
-    
-    // Recursively process left subtree
-    perform_postorder_traversal(current_node->left_child_ptr, traversal_results);
-    
-    // Recursively process right subtree
-    perform_postorder_traversal(current_node->right_child_ptr, traversal_results);
-    
-    // Process current node data last
-    traversal_results.push_back(current_node->data_payload);
 }
 
-// Calculate maximum height of binary tree using recursive approach
-int calculate_tree_height(TreeNode* current_node) {
-    // Base case: empty subtree has height 0
-    if (current_node == nullptr) {
-        return 0;
+void PhaseTaskGraph::run_task(size_t task_index) {
+    auto task_start = std::chrono::steady_clock::now();
+    phase_tasks[task_index].task_body();
+    phase_tasks[task_index].wall_milliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - task_start).count();
+}
+
+void PhaseTaskGraph::run_serial() {
+    for (size_t task_index = 0; task_index < phase_tasks.size(); task_index++) {
+        run_task(task_index);
+    }
+}
+
+// Workers take the earliest ready task; finishing one releases dependents whose count reaches zero
+void PhaseTaskGraph::run_concurrent(unsigned thread_count) {
+    std::mutex graph_mutex;
+    std::condition_variable task_ready;
+    std::vector<size_t> pending_dependencies(phase_tasks.size());
+    std::vector<size_t> ready_tasks;
+    size_t finished_count = 0;
+    for (size_t task_index = 0; task_index < phase_tasks.size(); task_index++) {
+        pending_dependencies[task_index] = phase_tasks[task_index].dependency_count;
+        if (pending_dependencies[task_index] == 0) {
+            ready_tasks.push_back(task_index);
+        }
     }
     
-    // Calculate height of left subtree
-    int left_subtree_height = calculate_tree_height(current_node->left_child_ptr);
-    
-    // Calculate height of right subtree
-    int right_subtree_height = calculate_tree_height(current_node->right_child_ptr);
+    auto worker_loop = [&]() {
+        std::unique_lock<std::mutex> graph_lock(graph_mutex);
+        for (;;) {
+            task_ready.wait(graph_lock, [&]() { return !ready_tasks.empty() || finished_count == phase_tasks.size(); });
+            if (ready_tasks.empty()) {
+                return;
+            }
+            std::vector<size_t>::iterator earliest_ready = std::min_element(ready_tasks.begin(), ready_tasks.end());
+            size_t task_index = *earliest_ready;
+            ready_tasks.erase(earliest_ready);
+            
+            graph_lock.unlock();
+            run_task(task_index);
+            graph_lock.lock();
+            
+            finished_count++;
+            for (size_t dependent_index : phase_tasks[task_index].dependent_tasks) {
+                if (--pending_dependencies[dependent_index] == 0) {
+                    ready_tasks.push_back(dependent_index);
+                }
+            }
+            task_ready.notify_all();
+        }
+    };
     
-    // Return maximum height plus current level
-    return 1 + std::max(left_subtree_height, right_subtree_height);
+    unsigned worker_threads = static_cast<unsigned>(std::min<size_t>(std::max(thread_count, 1u), std::max<size_t>(phase_tasks.size(), 1)));
+    std::vector<std::thread> worker_pool;
+    for (unsigned worker_index = 0; worker_index < worker_threads; worker_index++) {
+        worker_pool.emplace_back(worker_loop);
+    }
+    for (std::thread& worker_thread : worker_pool) {
+        worker_thread.join();
+    }
 }
 
-// Count total number of nodes in binary tree recursively
-int count_total_nodes(TreeNode* current_node) {
-    // Base case: null node contributes 0 to count
-    if (current_node == nullptr) {
-        return 0;
+ThreadedTreeNode::ThreadedTreeNode(int value, ThreadedTreeNode* predecessor_ptr, ThreadedTreeNode* successor_ptr)
+    : data_payload(value), left_child_ptr(predecessor_ptr), right_child_ptr(successor_ptr) {
+    allocation_ledger.record_node_allocation(1, sizeof(ThreadedTreeNode), 1);
+}
+
+ThreadedTreeNode::~ThreadedTreeNode() {
+    allocation_ledger.record_node_release(1, sizeof(ThreadedTreeNode), 1);
+}
+
+// Release in key order: each successor is still live when it is read
+ThreadedBinaryTree::~ThreadedBinaryTree() {
+    ThreadedTreeNode* current_node = const_cast<ThreadedTreeNode*>(first_node());
+    while (current_node != nullptr) {
+        ThreadedTreeNode* next_node = const_cast<ThreadedTreeNode*>(successor(current_node));
+        delete current_node;
+        current_node = next_node;
+    }
+}
+
+// Descend to the attachment point; the new leaf inherits the parent's thread on its outer side
+bool ThreadedBinaryTree::insert_key(int key_value) {
+    ThreadedTreeNode* parent_ptr = nullptr;
+    ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr) {
+        if (key_value == current_node->data_payload) {
+            return false;
+        }
+        parent_ptr = current_node;
+        if (key_value < current_node->data_payload) {
+            if (current_node->left_is_thread) {
+                break;
+            }
+            current_node = current_node->left_child_ptr;
+        } else {
+            if (current_node->right_is_thread) {
+                break;
+            }
+            current_node = current_node->right_child_ptr;
+        }
     }
     
-    // Return count of current node plus left and right subtrees
-    return 1 + count_total_nodes(current_node->left_child_ptr) + count_total_nodes(current_node->right_child_ptr);
+    if (parent_ptr == nullptr) {
+        root_node = new ThreadedTreeNode(key_value, nullptr, nullptr);
+    } else if (key_value < parent_ptr->data_payload) {
+        // Parent was this key's successor; its predecessor thread passes to the new leaf
+        ThreadedTreeNode* leaf_ptr = new ThreadedTreeNode(key_value, parent_ptr->left_child_ptr, parent_ptr);
+        parent_ptr->left_child_ptr = leaf_ptr;
+        parent_ptr->left_is_thread = false;
+    } else {
+        // Parent was this key's predecessor; its successor thread passes to the new leaf
+        ThreadedTreeNode* leaf_ptr = new ThreadedTreeNode(key_value, parent_ptr, parent_ptr->right_child_ptr);
+        parent_ptr->right_child_ptr = leaf_ptr;
+        parent_ptr->right_is_thread = false;
+    }
+    node_count++;
+    return true;
 }
 
-// Search for specific value in binary search tree
-bool search_node_value(TreeNode* current_node, int target_value) {
-    // Base case: reached null node (value not found)
+// Two children: move the successor's key up and unlink the successor (it has no left child)
+bool ThreadedBinaryTree::erase_key(int key_value) {
+    ThreadedTreeNode* parent_ptr = nullptr;
+    ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr && current_node->data_payload != key_value) {
+        parent_ptr = current_node;
+        if (key_value < current_node->data_payload) {
+            current_node = current_node->left_is_thread ? nullptr : current_node->left_child_ptr;
+        } else {
+            current_node = current_node->right_is_thread ? nullptr : current_node->right_child_ptr;
+        }
+    }
     if (current_node == nullptr) {
         return false;
     }
     
-    // Target value found at current node
-    if (current_node->data_payload == target_value) {
-        return true;
+    if (!current_node->left_is_thread && !current_node->right_is_thread) {
+        ThreadedTreeNode* successor_parent_ptr = current_node;
+        ThreadedTreeNode* successor_ptr = current_node->right_child_ptr;
+        while (!successor_ptr->left_is_thread) {
+            successor_parent_ptr = successor_ptr;
+            successor_ptr = successor_ptr->left_child_ptr;
+        }
+        current_node->data_payload = successor_ptr->data_payload;
+        parent_ptr = successor_parent_ptr;
+        current_node = successor_ptr;
     }
+    unlink_node(parent_ptr, current_node);
+    node_count--;
+    return true;
+}
+
+// Remove a node with at most one child, repairing the one thread that pointed at it
+void ThreadedBinaryTree::unlink_node(ThreadedTreeNode* parent_ptr, ThreadedTreeNode* node_ptr) {
+    // Identify the parent slot by pointer: keys may have just been overwritten by erase_key()
+    bool is_left_child = parent_ptr != nullptr && !parent_ptr->left_is_thread && parent_ptr->left_child_ptr == node_ptr;
     
-    // Search left subtree for smaller target value
-    if (target_value < current_node->data_payload) {
-        return search_node_value(current_node->left_child_ptr, target_value);
-    }
-    // Search right subtree for larger target value
-    else {
-        return search_node_value(current_node->right_child_ptr, target_value);
+    if (node_ptr->left_is_thread && node_ptr->right_is_thread) {
+        // Leaf: the parent slot becomes a thread to the leaf's neighbour on that side
+        if (parent_ptr == nullptr) {
+            root_node = nullptr;
+        } else if (is_left_child) {
+            parent_ptr->left_child_ptr = node_ptr->left_child_ptr;
+            parent_ptr->left_is_thread = true;
+        } else {
+            parent_ptr->right_child_ptr = node_ptr->right_child_ptr;
+            parent_ptr->right_is_thread = true;
+        }
+    } else {
+        // One child: splice it in; the neighbour whose thread named this node is re-pointed past it
+        ThreadedTreeNode* child_ptr = node_ptr->left_is_thread ? node_ptr->right_child_ptr : node_ptr->left_child_ptr;
+        ThreadedTreeNode* predecessor_ptr = const_cast<ThreadedTreeNode*>(predecessor(node_ptr));
+        ThreadedTreeNode* successor_ptr = const_cast<ThreadedTreeNode*>(successor(node_ptr));
+        if (parent_ptr == nullptr) {
+            root_node = child_ptr;
+        } else if (is_left_child) {
+            parent_ptr->left_child_ptr = child_ptr;
+        } else {
+            parent_ptr->right_child_ptr = child_ptr;
+        }
+        if (!node_ptr->left_is_thread) {
+            predecessor_ptr->right_child_ptr = successor_ptr;   // Maximum of the left subtree
+        } else {
+            successor_ptr->left_child_ptr = predecessor_ptr;    // Minimum of the right subtree
+        }
     }
+    delete node_ptr;
 }
 
-// Display visual progress indicator for operations
-void display_progress_indicator(int current_step, int total_steps) {
-    const int progress_bar_width = 20;
-    int filled_segments = (current_step * progress_bar_width) / total_steps;
-    
-    std::cout << "[";
-    for (int segment_index = 0; segment_index < progress_bar_width; segment_index++) {
-        if (segment_index < filled_segments) {
-            std::cout << "=";
+bool ThreadedBinaryTree::contains_key(int key_value) const {
+    const ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr) {
+        if (key_value == current_node->data_payload) {
+            return true;
+        }
+        if (key_value < current_node->data_payload) {
+            current_node = current_node->left_is_thread ? nullptr : current_node->left_child_ptr;
         } else {
-            std::cout << " ";
+            current_node = current_node->right_is_thread ? nullptr : current_node->right_child_ptr;
         }
     }
-    std::cout << "] " << std::setw(3) << (current_step * 100) / total_steps << "%";
+    return false;
 }
 
-// Display formatted traversal results with professional presentation
-void display_traversal_results(const std::vector<int>& results, const std::string& traversal_type) {
-    std::cout << traversal_type << " Traversal: ";
-    
-    for (size_t element_index = 0; element_index < results.size(); element_index++) {
-        std::cout << results[element_index];
-        if (element_index < results.size() - 1) {
-            std::cout << " -> ";
+const ThreadedTreeNode* ThreadedBinaryTree::first_node() const {
+    const ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr && !current_node->left_is_thread) {
+        current_node = current_node->left_child_ptr;
+    }
+    return current_node;
+}
+
+const ThreadedTreeNode* ThreadedBinaryTree::last_node() const {
+    const ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr && !current_node->right_is_thread) {
+        current_node = current_node->right_child_ptr;
+    }
+    return current_node;
+}
+
+// Remember the last node whose key is >= the target on the way down
+const ThreadedTreeNode* ThreadedBinaryTree::lower_bound_node(int key_value) const {
+    const ThreadedTreeNode* candidate_node = nullptr;
+    const ThreadedTreeNode* current_node = root_node;
+    while (current_node != nullptr) {
+        if (current_node->data_payload >= key_value) {
+            candidate_node = current_node;
+            current_node = current_node->left_is_thread ? nullptr : current_node->left_child_ptr;
+        } else {
+            current_node = current_node->right_is_thread ? nullptr : current_node->right_child_ptr;
         }
     }
-    std::cout << std::endl;
+    return candidate_node;
 }
 
-// Perform comprehensive statistical analysis on dataset
-void perform_statistical_analysis(const std::vector<int>& dataset) {
-    if (dataset.empty()) {
-        std::cout << "No data available for statistical analysis.\n";
-        return;
+// A right thread is the answer; otherwise the leftmost node of the right subtree
+const ThreadedTreeNode* ThreadedBinaryTree::successor(const ThreadedTreeNode* node_ptr) {
+    if (node_ptr->right_is_thread) {
+        return node_ptr->right_child_ptr;
     }
-    
-    // Calculate sum and mean value
-    int sum_total = 0;
-    for (int value : dataset) {
-        sum_total += value;
+    const ThreadedTreeNode* current_node = node_ptr->right_child_ptr;
+    while (!current_node->left_is_thread) {
+        current_node = current_node->left_child_ptr;
     }
-    double mean_value = static_cast<double>(sum_total) / dataset.size();
-    
-    // Find minimum and maximum values
-    int minimum_value = *std::min_element(dataset.begin(), dataset.end());
-    int maximum_value = *std::max_element(dataset.begin(), dataset.end());
-    
-    // Calculate range and median
-    int value_range = maximum_value - minimum_value;
-    std::vector<int> sorted_dataset = dataset;
-    std::sort(sorted_dataset.begin(), sorted_dataset.end());
-    double median_value = (sorted_dataset.size() % 2 == 0) ?
-        (sorted_dataset[sorted_dataset.size()/2 - 1] + sorted_dataset[sorted_dataset.size()/2]) / 2.0 :
-        sorted_dataset[sorted_dataset.size()/2];
-    
-    // Display statistical metrics
-    std::cout << "Dataset Size: " << dataset.size() << " elements\n";
-    std::cout << "Sum Total: " << sum_total << std::endl;
-    std::cout << "Mean Value: " << std::fixed << std::setprecision(2) << mean_value << std::endl;
-    std::cout << "Median Value: " << std::fixed << std::setprecision(2) << median_value << std::endl;
-    std::cout << "Minimum Value: " << minimum_value << std::endl;
-    std::cout << "Maximum Value: " << maximum_value << std::endl;
-    std::cout << "Value Range: " << value_range << std::endl;
+    return current_node;
 }
 
-// Recursive memory deallocation for entire tree structure
-void deallocate_tree_memory(TreeNode* current_node) {
-    // Base case: null node requires no deallocation
+const ThreadedTreeNode* ThreadedBinaryTree::predecessor(const ThreadedTreeNode* node_ptr) {
+    if (node_ptr->left_is_thread) {
+        return node_ptr->left_child_ptr;
+    }
+    const ThreadedTreeNode* current_node = node_ptr->left_child_ptr;
+    while (!current_node->right_is_thread) {
+        current_node = current_node->right_child_ptr;
+    }
+    return current_node;
+}
+
+// Stackless in-order walk; the visitor returns false to stop early
+template <typename KeyVisitor> bool ThreadedBinaryTree::visit_inorder(KeyVisitor&& key_visitor) const {
+    for (const ThreadedTreeNode* current_node = first_node(); current_node != nullptr; current_node = successor(current_node)) {
+        if (!key_visitor(current_node->data_payload)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The recursive in-order traversal the driver used originally, kept as the benchmark baseline
+static void sum_inorder_recursive(TreeNode* current_node, long long& key_sum) {
     if (current_node == nullptr) {
         return;
     }
+    sum_inorder_recursive(current_node->left_child_ptr, key_sum);
+    key_sum += current_node->data_payload;
+    sum_inorder_recursive(current_node->right_child_ptr, key_sum);
+}
+
+// Smallest key strictly greater than key_bound by descent from the root (the plain tree has no parent links)
+static TreeNode* next_greater_node(TreeNode* root_ptr, long long key_bound) {
+    TreeNode* candidate_node = nullptr;
+    while (root_ptr != nullptr) {
+        if (root_ptr->data_payload > key_bound) {
+            candidate_node = root_ptr;
+            root_ptr = root_ptr->left_child_ptr;
+        } else {
+            root_ptr = root_ptr->right_child_ptr;
+        }
+    }
+    return candidate_node;
+}
+
+// Full in-order scans (recursive, explicit stack, threaded) and successor chains (root descent vs threads)
+void run_threaded_tree_benchmark(size_t key_count) {
+    const size_t chain_length = 64;
+    const size_t chain_count = 20000;
+    std::mt19937 random_engine(50);
+    std::uniform_int_distribution<int> key_distribution(INT_MIN, INT_MAX);
+    TreeNode* root_ptr = nullptr;
+    ThreadedBinaryTree threaded_tree;
+    std::vector<int> inserted_keys;
+    for (size_t key_index = 0; key_index < key_count; key_index++) {
+        int key_value = key_distribution(random_engine);
+        if (insert_node_unique(root_ptr, key_value)) {
+            threaded_tree.insert_key(key_value);
+            inserted_keys.push_back(key_value);
+        }
+    }
+    size_t node_count = threaded_tree.size();
+    int repetitions = static_cast<int>(std::max<size_t>(1, 4000000 / std::max<size_t>(node_count, 1)));
+    console_output << "Threaded tree benchmark with " << node_count << " nodes, " << repetitions << " scan repetitions\n";
+    
+    // Full scans: sum every key
+    long long scan_sums[3] = {0, 0, 0};
+    double scan_seconds[3];
+    const char* scan_labels[] = {"recursive", "explicit stack", "threaded"};
+    for (int scan_index = 0; scan_index < 3; scan_index++) {
+        auto scan_start = std::chrono::steady_clock::now();
+        for (int repetition = 0; repetition < repetitions; repetition++) {
+            long long key_sum = 0;
+            if (scan_index == 0) {
+                sum_inorder_recursive(root_ptr, key_sum);
+            } else if (scan_index == 1) {
+                visit_inorder(root_ptr, [&key_sum](int key_value) {
+                    key_sum += key_value;
+                    return true;
+                });
+            } else {
+                threaded_tree.visit_inorder([&key_sum](int key_value) {
+                    key_sum += key_value;
+                    return true;
+                });
+            }
+            scan_sums[scan_index] = key_sum;
+        }
+        scan_seconds[scan_index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - scan_start).count();
+    }
+    double nodes_scanned = static_cast<double>(node_count) * repetitions;
+    for (int scan_index = 0; scan_index < 3; scan_index++) {
+        console_output << "  scan " << scan_labels[scan_index] << ": "
+                       << FixedPrecision(scan_seconds[scan_index] * 1e9 / nodes_scanned, 2) << " ns/node\n";
+    }
     
-    // Recursively deallocate left subtree
-    deallocate_tree_memory(current_node->left_child_ptr);
+    // Successor chains from random start keys
+    std::vector<int> chain_starts(chain_count);
+    for (int& start_key : chain_starts) {
+        start_key = key_distribution(random_engine);
+    }
+    long long descent_checksum = 0;
+    auto descent_start = std::chrono::steady_clock::now();
+    for (int start_key : chain_starts) {
+        TreeNode* current_node = next_greater_node(root_ptr, static_cast<long long>(start_key) - 1);
+        for (size_t step = 0; step < chain_length && current_node != nullptr; step++) {
+            descent_checksum += current_node->data_payload;
+            current_node = next_greater_node(root_ptr, current_node->data_payload);
+        }
+    }
+    double descent_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - descent_start).count();
     
-    // Recursively deallocate right subtree
-    deallocate_tree_memory(current_node->right_child_ptr);
+    long long threaded_checksum = 0;
+    auto threaded_start = std::chrono::steady_clock::now();
+    for (int start_key : chain_starts) {
+        const ThreadedTreeNode* current_node = threaded_tree.lower_bound_node(start_key);
+        for (size_t step = 0; step < chain_length && current_node != nullptr; step++) {
+            threaded_checksum += current_node->data_payload;
+            current_node = ThreadedBinaryTree::successor(current_node);
+        }
+    }
+    double threaded_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - threaded_start).count();
+    double chain_steps = static_cast<double>(chain_count) * chain_length;
+    console_output << "  successor chains (" << chain_count << " x " << chain_length << "): root descent "
+                   << FixedPrecision(descent_seconds * 1e9 / chain_steps, 2) << " ns/step, threaded "
+                   << FixedPrecision(threaded_seconds * 1e9 / chain_steps, 2) << " ns/step\n";
     
-    // Deallocate current node memory
-    delete current_node;
+    // Threads must survive deletes: erase every other key from both trees and compare both directions
+    for (size_t key_index = 0; key_index < inserted_keys.size(); key_index += 2) {
+        delete_node_value(root_ptr, inserted_keys[key_index]);
+        threaded_tree.erase_key(inserted_keys[key_index]);
+    }
+    std::vector<int> expected_keys;
+    perform_inorder_traversal(root_ptr, expected_keys);
+    std::vector<int> forward_keys;
+    threaded_tree.visit_inorder([&forward_keys](int key_value) {
+        forward_keys.push_back(key_value);
+        return true;
+    });
+    std::vector<int> backward_keys;
+    for (const ThreadedTreeNode* current_node = threaded_tree.last_node(); current_node != nullptr;
+         current_node = ThreadedBinaryTree::predecessor(current_node)) {
+        backward_keys.push_back(current_node->data_payload);
+    }
+    std::reverse(backward_keys.begin(), backward_keys.end());
+    bool results_match = scan_sums[0] == scan_sums[1] && scan_sums[1] == scan_sums[2] &&
+                         descent_checksum == threaded_checksum && forward_keys == expected_keys &&
+                         backward_keys == expected_keys && threaded_tree.size() == expected_keys.size();
+    console_output << "  " << (results_match ? "scans, chains and post-delete order match" : "RESULT MISMATCH") << '\n';
+    deallocate_tree_memory(root_ptr);
+    console_output.flush();
 }
\ No newline at end of file